@@ -1,29 +1,10 @@
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <vector>
-#include <unordered_map>
-#include <set>
-const std::string ALPHABET    = ".ALPHABET";
-const std::string STATES      = ".STATES";
-const std::string TRANSITIONS = ".TRANSITIONS";
-const std::string INPUT       = ".INPUT";
-const std::string EMPTY       = ".EMPTY";
+#include <string_view>
+#include <utility>
+#include "dfatable.h"
 
-std::set<char> alphabet;
-std::set<std::string> states;
-std::set<std::string> accepting_states;
-std::unordered_map<std::string, std::unordered_map<char, std::string>> transitions;
-std::string starting_state;
-
-bool isChar(std::string s) {
-  return s.length() == 1;
-}
-bool isRange(std::string s) {
-  return s.length() == 3 && s[1] == '-';
-}
-
-unsigned char mips_dfa[] = {
+constexpr char mips_dfa[] = {
   0x2e, 0x41, 0x4c, 0x50, 0x48, 0x41, 0x42, 0x45, 0x54, 0x0a, 0x24, 0x20,
   0x30, 0x2d, 0x39, 0x20, 0x61, 0x2d, 0x7a, 0x20, 0x2e, 0x20, 0x41, 0x2d,
   0x5a, 0x20, 0x2c, 0x20, 0x28, 0x20, 0x29, 0x20, 0x3a, 0x20, 0x2d, 0x0a,
@@ -75,127 +56,147 @@ unsigned char mips_dfa[] = {
   0x2d, 0x66, 0x20, 0x68, 0x65, 0x78, 0x0a, 0x68, 0x65, 0x78, 0x20, 0x41,
   0x2d, 0x46, 0x20, 0x68, 0x65, 0x78, 0x0a
 };
-unsigned int mips_dfa_len = 595;
+constexpr unsigned int mips_dfa_len = 595;
 
-// Locations in the program that you should modify to store the
-// DFA information have been marked with four-slash comments:
-//// (Four-slash comment)
-int main() {
+constexpr std::pair<std::string_view, std::string_view> names[] = {
+  {"reg1", "REG"},
+  {"reg2", "REG"},
+  {"comma", "COMMA"},
+  {"directive", "DIRECTIVE"},
+  {"hex", "HEXINT"},
+  {"label", "LABEL"},
+  {"lparen", "LPAREN"},
+  {"rparen", "RPAREN"},
+  {"id", "ID"},
+  {"zero", "DEC"},
+  {"dec", "DEC"},
+};
 
-  std::unordered_map<std::string, std::string> names;
-  names.insert({"reg1", "REG"});
-  names.insert({"reg2", "REG"});
-  names.insert({"comma", "COMMA"});
-  names.insert({"directive", "DIRECTIVE"});
-  names.insert({"hex", "HEXINT"});
-  names.insert({"label", "LABEL"});
-  names.insert({"lparen", "LPAREN"});
-  names.insert({"rparen", "RPAREN"});
-  names.insert({"id", "ID"});
-  names.insert({"zero", "DEC"});
-  names.insert({"dec", "DEC"});
+constexpr std::string_view MIPS_DFA_TEXT{mips_dfa, mips_dfa_len};
+constexpr int NUM_DFA_STATES = countDfaStates(MIPS_DFA_TEXT);
 
-  std::string s;
-  std::string foo((char *) mips_dfa, mips_dfa_len);
-  std::stringstream in(foo);
-  
-  std::getline(in, s); // Alphabet section (skip header)
-  // Read characters or ranges separated by whitespace
-  while(in >> s) {
-    if (s == STATES) { 
-      break; 
-    } else {
-      if (isChar(s)) {
-        alphabet.insert(char(s[0]));
-      } else if (isRange(s)) {
-        for(char c = s[0]; c <= s[2]; ++c) {
-          alphabet.insert(c);
-        }
-      } 
-    }
+constexpr std::string_view stateKind(std::string_view name) {
+  for (const auto& entry : names) {
+    if (entry.first == name) return entry.second;
   }
+  return "";
+}
 
-  std::getline(in, s); // States section (skip header)
-  // Read states separated by whitespace
-  while(in >> s) {
-    if (s == TRANSITIONS) { 
-      break; 
-    } else {
-      static bool initial = true;
-      bool accepting = false;
-      if (s.back() == '!' && !isChar(s)) {
-        accepting = true;
-        s.pop_back();
-      }
-      if (initial) {
-        starting_state = s;
-        initial = false;
-      }
-      if (accepting) {
-        accepting_states.insert(s);
-      }
-      states.insert(s);
-      transitions[s];
+// Transition and accept tables are built from mips_dfa at compile time.
+// States that produce the same kind of token may then be merged.
+constexpr DfaTables<NUM_DFA_STATES> full_dfa = buildDfa<NUM_DFA_STATES>(MIPS_DFA_TEXT);
+constexpr std::array<int, NUM_DFA_STATES> state_labels = [] {
+  std::array<int, NUM_DFA_STATES> result{};
+  for (int i = 0; i < NUM_DFA_STATES; ++i) {
+    result[i] = -1;
+    for (int j = 0; j < int(std::size(names)) && result[i] == -1; ++j) {
+      if (names[j].second == stateKind(full_dfa.state_names[i])) result[i] = j;
     }
   }
+  return result;
+}();
+constexpr std::array<int, NUM_DFA_STATES> state_numbers = minimizedStates(full_dfa, state_labels);
+constexpr int NUM_STATES = countMinimizedStates(state_numbers);
+constexpr DfaTables<NUM_STATES> dfa = minimizeDfa<NUM_STATES>(full_dfa, state_numbers);
 
-  std::getline(in, s); // Transitions section (skip header)
-  // Read transitions line-by-line
-  while(std::getline(in, s)) {
-    if (s == INPUT) { 
-      // Note: Since we're reading line by line, once we encounter the
-      // input header, we will already be on the line after the header
-      break; 
-    } else {
-      std::string fromState, symbols, toState;
-      std::istringstream line(s);
-      std::vector<std::string> lineVec;
-      while(line >> s) {
-        lineVec.push_back(s);
-      }
-      fromState = lineVec.front();
-      toState = lineVec.back();
-      for(int i = 1; i < lineVec.size()-1; ++i) {
-        std::string s = lineVec[i];
-        if (isChar(s)) {
-          symbols += s;
-        } else if (isRange(s)) {
-          for(char c = s[0]; c <= s[2]; ++c) {
-            symbols += c;
-          }
-        }
-      }
-      for ( char c : symbols ) {
-        if (alphabet.find(c) != alphabet.end() && states.find(fromState) != states.end() && states.find(toState) != states.end()) {
-          transitions[fromState][c] = toState;
-        }
-      }
+constexpr std::array<std::string_view, NUM_STATES> token_kind = [] {
+  std::array<std::string_view, NUM_STATES> result{};
+  for (int i = 0; i < NUM_STATES; ++i) result[i] = stateKind(dfa.state_names[i]);
+  return result;
+}();
+
+// Bytes that every state treats alike share a class, so the transition
+// table only needs one column per class: a 256-entry class lookup plus a
+// NUM_STATES x NUM_CLASSES table that fits in a few cache lines.
+constexpr std::array<unsigned char, 256> byte_class = [] {
+  std::array<unsigned char, 256> result{};
+  std::array<int, 256> representative{};
+  int count = 0;
+  for (int c = 0; c < 256; ++c) {
+    int cls = -1;
+    for (int k = 0; k < count && cls == -1; ++k) {
+      bool same = true;
+      for (int s = 0; s < NUM_STATES && same; ++s) same = dfa.next(s, c) == dfa.next(s, representative[k]);
+      if (same) cls = k;
+    }
+    if (cls == -1) {
+      cls = count;
+      representative[count++] = c;
     }
+    result[c] = (unsigned char) cls;
   }
+  return result;
+}();
 
-  std::istream& input = std::cin;
-  while (std::getline(input, s)) {
-    std::string lexeme = "";
-    std::string curr_state = starting_state;
-    std::istringstream iss(s);
-    char c;
+constexpr int NUM_CLASSES = [] {
+  int count = 0;
+  for (unsigned char cls : byte_class) {
+    if (cls + 1 > count) count = cls + 1;
+  }
+  return count;
+}();
 
-    // Input section (already skipped header)
-    while (iss.get(c)) {
-        if (lexeme.length() == 0 && c == ' ') continue;
-        if (transitions.find(curr_state) != transitions.end() && transitions[curr_state].find(c) != transitions[curr_state].end()) {
-            curr_state = transitions[curr_state][c];
-            lexeme += c;
-        }
-        else {
-            if (lexeme.length() > 0 && c != ' ') iss.putback (c);
-            if (accepting_states.find(curr_state) != accepting_states.end()) std::cout << names[curr_state] << " " << lexeme << std::endl;
-            else std::cerr << "ERROR" << std::endl;
-            lexeme = "";
-            curr_state = starting_state;
-        }
+constexpr std::array<signed char, NUM_STATES * NUM_CLASSES> class_transitions = [] {
+  std::array<signed char, NUM_STATES * NUM_CLASSES> result{};
+  for (int s = 0; s < NUM_STATES; ++s) {
+    for (int c = 0; c < 256; ++c) result[s * NUM_CLASSES + byte_class[c]] = (signed char) dfa.next(s, c);
+  }
+  return result;
+}();
+
+static_assert([] {
+  for (int s = 0; s < NUM_STATES; ++s) {
+    if (dfa.next(s, ' ') != DEAD_STATE || dfa.next(s, '\n') != DEAD_STATE) return false;
+  }
+  return true;
+}(), "tokens must not contain a space or a newline");
+
+std::string readAll(std::istream& in) {
+  std::string data;
+  char buffer[1 << 16];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+    data.append(buffer, in.gcount());
+  }
+  return data;
+}
+
+// Lexes all of stdin as one buffer. No state has a transition on a space
+// or a newline, so scanning straight through gives the same tokens as
+// scanning line by line. Tokens are collected in one output buffer, which
+// is flushed before each error so the two streams still interleave as
+// they did when every token was written with std::endl.
+int main() {
+  std::string text = readAll(std::cin);
+  std::string out;
+  const char* p = text.data();
+  const char* end = p + text.size();
+
+  while (p < end) {
+    if (*p == ' ' || *p == '\n') {
+      ++p;
+      continue;
+    }
+    int state = dfa.start;
+    const char* q = p;
+    while (q < end) {
+      int next_state = class_transitions[state * NUM_CLASSES + byte_class[(unsigned char) *q]];
+      if (next_state == DEAD_STATE) break;
+      state = next_state;
+      ++q;
     }
-    if (accepting_states.find(curr_state) != accepting_states.end()) std::cout << names[curr_state] << " " << lexeme << std::endl;
-    else if (lexeme.length() > 0) std::cerr << "ERROR" << std::endl;
+    if (dfa.accepting[state]) {
+      out += token_kind[state];
+      out += ' ';
+      out.append(p, q - p);
+      out += '\n';
+    } else {
+      std::cout << out << std::flush;
+      out.clear();
+      std::cerr << "ERROR" << std::endl;
+    }
+    // The offending character starts the next lexeme, unless nothing
+    // was matched before it.
+    p = q == p ? p + 1 : q;
   }
-}
\ No newline at end of file
+  std::cout << out;
+}
@@ -0,0 +1,323 @@
+#ifndef DFATABLE_H
+#define DFATABLE_H
+#include <array>
+#include <string_view>
+#include <type_traits>
+
+// Compile-time construction of scanner tables from the DFA description
+// format used by the scanners (.ALPHABET, .STATES and .TRANSITIONS
+// sections). The text is parsed with the same rules as the old runtime
+// loaders: single characters and a-z style ranges are symbols, a trailing
+// '!' marks an accepting state, and transitions on symbols outside the
+// alphabet or between undeclared states are ignored.
+//
+// minimizedStates() and minimizeDfa() then merge equivalent states and
+// renumber the rest, so the scanners run on the smallest table that
+// behaves the same.
+
+const int DEAD_STATE = -1;
+
+// Where a longest match stopped and the state it stopped in.
+struct DfaMatch {
+    const char* end;
+    int state;
+};
+
+template <int NumStates>
+struct DfaTables {
+    // Small machines store a state number in one byte, so a whole table
+    // row is 256 bytes.
+    using State = std::conditional_t<(NumStates < 128), signed char, short>;
+
+    int start = 0;
+    std::array<std::string_view, NumStates> state_names{};
+    std::array<bool, NumStates> accepting{};
+    std::array<State, NumStates * 256> transitions{};
+
+    constexpr int stateId(std::string_view name) const {
+        for (int i = 0; i < NumStates; ++i) {
+            if (state_names[i] == name) return i;
+        }
+        return DEAD_STATE;
+    }
+
+    constexpr int next(int state, unsigned char c) const {
+        return transitions[state * 256 + c];
+    }
+
+    // Follows transitions from the start state for as long as there are
+    // any, without backing up to an earlier accepting state. Whether
+    // [p, match.end) is a token is up to the caller, from match.state.
+    constexpr DfaMatch longestMatch(const char* p, const char* end) const {
+        int state = start;
+        while (p < end) {
+            int next_state = next(state, (unsigned char) *p);
+            if (next_state == DEAD_STATE) break;
+            state = next_state;
+            ++p;
+        }
+        return {p, state};
+    }
+};
+
+constexpr bool isDfaSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+// Reads the next whitespace-separated word, crossing line boundaries.
+constexpr std::string_view nextDfaWord(std::string_view text, size_t& pos) {
+    while (pos < text.size() && isDfaSpace(text[pos])) ++pos;
+    size_t begin = pos;
+    while (pos < text.size() && !isDfaSpace(text[pos])) ++pos;
+    return text.substr(begin, pos - begin);
+}
+
+// Reads the rest of the current line and moves past its newline.
+constexpr std::string_view nextDfaLine(std::string_view text, size_t& pos) {
+    size_t begin = pos;
+    while (pos < text.size() && text[pos] != '\n') ++pos;
+    std::string_view line = text.substr(begin, pos - begin);
+    if (pos < text.size()) ++pos;
+    return line;
+}
+
+constexpr bool isDfaChar(std::string_view s) {
+    return s.length() == 1;
+}
+
+constexpr bool isDfaRange(std::string_view s) {
+    return s.length() == 3 && s[1] == '-';
+}
+
+constexpr std::string_view stripAccepting(std::string_view s) {
+    if (s.back() == '!' && !isDfaChar(s)) s.remove_suffix(1);
+    return s;
+}
+
+// Number of distinct states declared in the .STATES section.
+constexpr int countDfaStates(std::string_view text) {
+    std::array<std::string_view, 1024> names{};
+    int count = 0;
+    size_t pos = 0;
+    nextDfaLine(text, pos); // Alphabet section (skip header)
+    while (pos < text.size() && nextDfaWord(text, pos) != ".STATES");
+    nextDfaLine(text, pos); // States section (skip header)
+    for (std::string_view s = nextDfaWord(text, pos); !s.empty() && s != ".TRANSITIONS"; s = nextDfaWord(text, pos)) {
+        s = stripAccepting(s);
+        bool seen = false;
+        for (int i = 0; i < count; ++i) {
+            if (names[i] == s) seen = true;
+        }
+        if (!seen) names[count++] = s;
+    }
+    return count;
+}
+
+template <int NumStates>
+constexpr DfaTables<NumStates> buildDfa(std::string_view text) {
+    DfaTables<NumStates> dfa;
+    for (auto& t : dfa.transitions) t = DEAD_STATE;
+    std::array<bool, 256> alphabet{};
+    size_t pos = 0;
+
+    nextDfaLine(text, pos); // Alphabet section (skip header)
+    for (std::string_view s = nextDfaWord(text, pos); !s.empty() && s != ".STATES"; s = nextDfaWord(text, pos)) {
+        if (isDfaChar(s)) {
+            alphabet[(unsigned char) s[0]] = true;
+        } else if (isDfaRange(s)) {
+            for (int c = (unsigned char) s[0]; c <= (unsigned char) s[2]; ++c) alphabet[c] = true;
+        }
+    }
+
+    nextDfaLine(text, pos); // States section (skip header)
+    int num_states = 0;
+    for (std::string_view s = nextDfaWord(text, pos); !s.empty() && s != ".TRANSITIONS"; s = nextDfaWord(text, pos)) {
+        bool accepting = stripAccepting(s).size() != s.size();
+        s = stripAccepting(s);
+        int id = dfa.stateId(s);
+        if (id == DEAD_STATE) {
+            id = num_states++;
+            dfa.state_names[id] = s;
+        }
+        if (accepting) dfa.accepting[id] = true;
+    }
+
+    nextDfaLine(text, pos); // Transitions section (skip header)
+    while (pos < text.size()) {
+        std::string_view line = nextDfaLine(text, pos);
+        if (line == ".INPUT") break;
+        std::array<std::string_view, 64> words{};
+        int num_words = 0;
+        size_t line_pos = 0;
+        for (std::string_view w = nextDfaWord(line, line_pos); !w.empty() && num_words < 64; w = nextDfaWord(line, line_pos)) {
+            words[num_words++] = w;
+        }
+        if (num_words < 2) continue;
+        int from = dfa.stateId(words[0]);
+        int to = dfa.stateId(words[num_words - 1]);
+        if (from == DEAD_STATE || to == DEAD_STATE) continue;
+        for (int i = 1; i < num_words - 1; ++i) {
+            std::string_view s = words[i];
+            int lo = 0, hi = -1;
+            if (isDfaChar(s)) {
+                lo = hi = (unsigned char) s[0];
+            } else if (isDfaRange(s)) {
+                lo = (unsigned char) s[0]; hi = (unsigned char) s[2];
+            }
+            for (int c = lo; c <= hi; ++c) {
+                if (alphabet[c]) dfa.transitions[from * 256 + c] = to;
+            }
+        }
+    }
+    return dfa;
+}
+
+// Partitions the states of dfa into classes of equivalent states with
+// Hopcroft's algorithm. Two states start in the same class only if they
+// agree on accepting and on labels, so callers can keep apart states they
+// treat differently; the dead state is a class of its own. Returns the
+// number of each state in the minimized DFA, or DEAD_STATE if it cannot
+// be reached. States are numbered in breadth-first order from the start
+// state, which becomes state 0, so states used together sit together.
+template <int N>
+constexpr std::array<int, N> minimizedStates(const DfaTables<N>& dfa, const std::type_identity_t<std::array<int, N>>& labels) {
+    // Index N stands for the dead state.
+    auto target = [&](int s, int c) {
+        int t = s == N ? DEAD_STATE : dfa.next(s, c);
+        return t == DEAD_STATE ? N : t;
+    };
+
+    // Bytes with identical columns behave identically, so only one byte
+    // per column (and none whose column is all dead) needs to split.
+    std::array<int, 256> symbols{};
+    int num_symbols = 0;
+    for (int c = 0; c < 256; ++c) {
+        bool live = false;
+        for (int s = 0; s < N; ++s) {
+            if (dfa.next(s, c) != DEAD_STATE) live = true;
+        }
+        for (int i = 0; i < num_symbols && live; ++i) {
+            bool same = true;
+            for (int s = 0; s < N && same; ++s) same = dfa.next(s, c) == dfa.next(s, symbols[i]);
+            if (same) live = false;
+        }
+        if (live) symbols[num_symbols++] = c;
+    }
+
+    std::array<int, N + 1> block{};
+    int num_blocks = 0;
+    for (int s = 0; s <= N; ++s) {
+        block[s] = -1;
+        for (int t = 0; t < s && s < N && block[s] == -1; ++t) {
+            if (labels[t] == labels[s] && dfa.accepting[t] == dfa.accepting[s]) block[s] = block[t];
+        }
+        if (block[s] == -1) block[s] = num_blocks++;
+    }
+
+    // Splitters are (block, symbol index) pairs.
+    std::array<bool, (N + 1) * 256> waiting{};
+    std::array<int, (N + 1) * 256> work{};
+    int num_work = 0;
+    for (int b = 0; b < num_blocks; ++b) {
+        for (int i = 0; i < num_symbols; ++i) {
+            waiting[b * 256 + i] = true;
+            work[num_work++] = b * 256 + i;
+        }
+    }
+    while (num_work > 0) {
+        int splitter = work[--num_work];
+        waiting[splitter] = false;
+        int a = splitter / 256, c = symbols[splitter % 256];
+        std::array<bool, N + 1> into_a{};
+        std::array<int, N + 1> inside{}, outside{};
+        for (int s = 0; s <= N; ++s) {
+            into_a[s] = block[target(s, c)] == a;
+            ++(into_a[s] ? inside : outside)[block[s]];
+        }
+        // Every block with states on both sides is split; the states that
+        // move into a go to a new block.
+        std::array<int, N + 1> split_to{};
+        for (int y = 0, old_blocks = num_blocks; y < old_blocks; ++y) {
+            split_to[y] = -1;
+            if (inside[y] == 0 || outside[y] == 0) continue;
+            int z = split_to[y] = num_blocks++;
+            for (int i = 0; i < num_symbols; ++i) {
+                int add = waiting[y * 256 + i] || inside[y] < outside[y] ? z : y;
+                if (!waiting[add * 256 + i]) {
+                    waiting[add * 256 + i] = true;
+                    work[num_work++] = add * 256 + i;
+                }
+            }
+        }
+        for (int s = 0; s <= N; ++s) {
+            if (into_a[s] && split_to[block[s]] != -1) block[s] = split_to[block[s]];
+        }
+    }
+
+    std::array<int, N + 1> number{};
+    std::array<int, N + 1> queue{};
+    for (auto& n : number) n = DEAD_STATE;
+    int head = 0, tail = 0;
+    number[block[dfa.start]] = tail;
+    queue[tail++] = dfa.start;
+    while (head < tail) {
+        int s = queue[head++];
+        for (int c = 0; c < 256; ++c) {
+            int t = target(s, c);
+            if (t != N && number[block[t]] == DEAD_STATE) {
+                number[block[t]] = tail;
+                queue[tail++] = t;
+            }
+        }
+    }
+    std::array<int, N> result{};
+    for (int s = 0; s < N; ++s) result[s] = number[block[s]];
+    return result;
+}
+
+// FNV-1a hash of a DFA's transitions and accepting states, for checking
+// that code generated from the tables is still up to date.
+template <int N>
+constexpr unsigned long long dfaFingerprint(const DfaTables<N>& dfa) {
+    unsigned long long hash = 14695981039346656037ull;
+    auto add = [&](int value) {
+        hash = (hash ^ (unsigned long long) (value & 0xffff)) * 1099511628211ull;
+    };
+    add(N);
+    add(dfa.start);
+    for (int s = 0; s < N; ++s) add(dfa.accepting[s]);
+    for (auto t : dfa.transitions) add(t);
+    return hash;
+}
+
+// Number of states in the minimized DFA, given minimizedStates().
+template <size_t N>
+constexpr int countMinimizedStates(const std::array<int, N>& number) {
+    int count = 0;
+    for (int n : number) {
+        if (n + 1 > count) count = n + 1;
+    }
+    return count;
+}
+
+// Builds the minimized DFA from minimizedStates(). Each state keeps the
+// name of the first original state merged into it.
+template <int M, int N>
+constexpr DfaTables<M> minimizeDfa(const DfaTables<N>& dfa, const std::type_identity_t<std::array<int, N>>& number) {
+    DfaTables<M> result;
+    for (auto& t : result.transitions) t = DEAD_STATE;
+    result.start = number[dfa.start];
+    for (int s = 0; s < N; ++s) {
+        int n = number[s];
+        if (n == DEAD_STATE || !result.state_names[n].empty()) continue;
+        result.state_names[n] = dfa.state_names[s];
+        result.accepting[n] = dfa.accepting[s];
+        for (int c = 0; c < 256; ++c) {
+            int t = dfa.next(s, c);
+            result.transitions[n * 256 + c] = t == DEAD_STATE ? DEAD_STATE : number[t];
+        }
+    }
+    return result;
+}
+
+#endif
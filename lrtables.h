@@ -0,0 +1,268 @@
+#ifndef LRTABLES_H
+#define LRTABLES_H
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "dfatable.h"
+
+// Compile-time construction of LR parse tables from the text format in
+// wlp4data.h: a .CFG section with one "lhs rhs..." production per line, a
+// .TRANSITIONS section of "state symbol state" lines and a .REDUCTIONS
+// section of "state production symbol" lines. Grammar symbols are
+// interned to small integers in order of first appearance and the
+// actions are laid out as dense [state][symbol] arrays, so a parser
+// using them does no table construction at startup. Lines are split with
+// the word and line readers from dfatable.h.
+
+struct LrProduction {
+    std::string_view lhs;
+    std::string_view rhs;
+    int lhs_symbol = -1;
+    int rhs_length = 0;
+};
+
+constexpr int parseLrNumber(std::string_view word) {
+    int value = 0;
+    for (char c : word) value = value * 10 + (c - '0');
+    return value;
+}
+
+// Calls f(words, count) for each non-empty line after the section header.
+template <typename F>
+constexpr void forEachLrLine(std::string_view section, F f) {
+    size_t pos = 0;
+    nextDfaLine(section, pos); // Section header
+    while (pos < section.size()) {
+        std::string_view line = nextDfaLine(section, pos);
+        std::array<std::string_view, 32> words{};
+        int count = 0;
+        size_t line_pos = 0;
+        for (std::string_view w = nextDfaWord(line, line_pos); !w.empty() && count < 32; w = nextDfaWord(line, line_pos)) {
+            words[count++] = w;
+        }
+        if (count > 0) f(words, count);
+    }
+}
+
+struct LrTableSizes {
+    int symbols = 0;
+    int states = 0;
+    int productions = 0;
+};
+
+// Counts distinct symbols, states (one more than the highest state
+// number) and productions, for sizing LrTables.
+constexpr LrTableSizes measureLrTables(std::string_view cfg, std::string_view transitions, std::string_view reductions) {
+    LrTableSizes sizes;
+    std::array<std::string_view, 1024> names{};
+    auto add = [&](std::string_view symbol) {
+        if (symbol == ".EMPTY") return;
+        for (int i = 0; i < sizes.symbols; ++i) {
+            if (names[i] == symbol) return;
+        }
+        names[sizes.symbols++] = symbol;
+    };
+    forEachLrLine(cfg, [&](const auto& words, int count) {
+        ++sizes.productions;
+        for (int i = 0; i < count; ++i) add(words[i]);
+    });
+    forEachLrLine(transitions, [&](const auto& words, int count) {
+        if (count != 3) return;
+        add(words[1]);
+        sizes.states = std::max(sizes.states, std::max(parseLrNumber(words[0]), parseLrNumber(words[2])) + 1);
+    });
+    forEachLrLine(reductions, [&](const auto& words, int count) {
+        if (count != 3) return;
+        add(words[2]);
+        sizes.states = std::max(sizes.states, parseLrNumber(words[0]) + 1);
+    });
+    return sizes;
+}
+
+template <int NumSymbols, int NumStates, int NumProductions>
+struct LrTables {
+    std::array<std::string_view, NumSymbols> symbol_names{};
+    // Symbol numbers sorted by name, for symbolId().
+    std::array<int, NumSymbols> sorted_symbols{};
+    std::array<LrProduction, NumProductions> productions{};
+    // Next state for shifting a symbol, or -1.
+    std::array<int16_t, NumStates * NumSymbols> shift{};
+    // Production to reduce by on a lookahead symbol, or -1.
+    std::array<int16_t, NumStates * NumSymbols> reduce{};
+
+    // Returns -1 for names that are not grammar symbols.
+    constexpr int symbolId(std::string_view name) const {
+        int lo = 0, hi = NumSymbols;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (symbol_names[sorted_symbols[mid]] < name) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < NumSymbols && symbol_names[sorted_symbols[lo]] == name ? sorted_symbols[lo] : -1;
+    }
+
+    constexpr int shiftAction(int state, int symbol) const {
+        return symbol < 0 ? -1 : shift[state * NumSymbols + symbol];
+    }
+
+    constexpr int reduceAction(int state, int symbol) const {
+        return symbol < 0 ? -1 : reduce[state * NumSymbols + symbol];
+    }
+};
+
+template <int NumSymbols, int NumStates, int NumProductions>
+constexpr LrTables<NumSymbols, NumStates, NumProductions> buildLrTables(std::string_view cfg, std::string_view transitions, std::string_view reductions) {
+    LrTables<NumSymbols, NumStates, NumProductions> tables;
+    int num_symbols = 0;
+    auto intern = [&](std::string_view symbol) {
+        for (int i = 0; i < num_symbols; ++i) {
+            if (tables.symbol_names[i] == symbol) return i;
+        }
+        tables.symbol_names[num_symbols] = symbol;
+        return num_symbols++;
+    };
+
+    int num_productions = 0;
+    forEachLrLine(cfg, [&](const auto& words, int count) {
+        LrProduction& production = tables.productions[num_productions++];
+        production.lhs = words[0];
+        production.lhs_symbol = intern(words[0]);
+        // The right-hand side runs from the second word to the end of the line.
+        production.rhs = count > 1 ? std::string_view(words[1].data(), words[count - 1].data() + words[count - 1].size() - words[1].data()) : std::string_view();
+        for (int i = 1; i < count; ++i) {
+            if (words[i] == ".EMPTY") continue;
+            intern(words[i]);
+            ++production.rhs_length;
+        }
+    });
+
+    for (auto& entry : tables.shift) entry = -1;
+    for (auto& entry : tables.reduce) entry = -1;
+    forEachLrLine(transitions, [&](const auto& words, int count) {
+        if (count != 3) return;
+        tables.shift[parseLrNumber(words[0]) * NumSymbols + intern(words[1])] = int16_t(parseLrNumber(words[2]));
+    });
+    forEachLrLine(reductions, [&](const auto& words, int count) {
+        if (count != 3) return;
+        tables.reduce[parseLrNumber(words[0]) * NumSymbols + intern(words[2])] = int16_t(parseLrNumber(words[1]));
+    });
+
+    for (int i = 0; i < NumSymbols; ++i) {
+        int j = i;
+        for (; j > 0 && tables.symbol_names[tables.sorted_symbols[j - 1]] > tables.symbol_names[i]; --j) {
+            tables.sorted_symbols[j] = tables.sorted_symbols[j - 1];
+        }
+        tables.sorted_symbols[j] = i;
+    }
+    return tables;
+}
+
+// Compressed form of the actions in LrTables, as in yacc: each state's
+// most common reduction becomes its default, and the remaining shift,
+// goto and reduce entries of every row are overlaid into one comb vector.
+// Row s occupies entries[base[s] + symbol] wherever check[] holds s. An
+// entry is a state to shift to, or -2 - production for a reduction.
+// Default reductions may run on a lookahead that is an error, but never
+// shift it, so errors are still caught at the same input token.
+template <int NumStates, int TableSize>
+struct CombLrTables {
+    std::array<int16_t, NumStates> base{};
+    std::array<int16_t, NumStates> default_reduction{};
+    std::array<int16_t, TableSize> entries{};
+    std::array<int16_t, TableSize> check{};
+
+    constexpr int entry(int state, int symbol) const {
+        if (symbol < 0) return -1;
+        int i = base[state] + symbol;
+        return i < TableSize && check[i] == state ? entries[i] : -1;
+    }
+
+    constexpr int shiftAction(int state, int symbol) const {
+        int action = entry(state, symbol);
+        return action >= 0 ? action : -1;
+    }
+
+    constexpr int reduceAction(int state, int symbol) const {
+        int action = entry(state, symbol);
+        if (action >= 0) return -1;
+        return action == -1 ? default_reduction[state] : -2 - action;
+    }
+};
+
+// Packs rows first-fit, fullest row first, and returns the table size.
+// With out set it also fills in the compressed tables.
+template <int NumSymbols, int NumStates, int NumProductions, typename Out>
+constexpr int packLrTables(const LrTables<NumSymbols, NumStates, NumProductions>& tables, Out* out) {
+    std::array<int, NumStates> defaults{};
+    std::array<int, NumStates> row_sizes{};
+    for (int s = 0; s < NumStates; ++s) {
+        // Production counts for this row; the first most common one wins.
+        std::array<int, NumProductions> counts{};
+        defaults[s] = -1;
+        for (int c = 0; c < NumSymbols; ++c) {
+            int r = tables.reduce[s * NumSymbols + c];
+            if (r < 0 || tables.shift[s * NumSymbols + c] >= 0) continue;
+            if (++counts[r] > (defaults[s] < 0 ? 0 : counts[defaults[s]])) defaults[s] = r;
+        }
+        for (int c = 0; c < NumSymbols; ++c) {
+            int r = tables.reduce[s * NumSymbols + c];
+            row_sizes[s] += tables.shift[s * NumSymbols + c] >= 0 || (r >= 0 && r != defaults[s]);
+        }
+    }
+    std::array<int, NumStates> order{};
+    for (int s = 0; s < NumStates; ++s) {
+        int j = s;
+        for (; j > 0 && row_sizes[order[j - 1]] < row_sizes[s]; --j) order[j] = order[j - 1];
+        order[j] = s;
+    }
+
+    // Owner state of each slot, or -1; rows never need more than this.
+    std::array<int16_t, NumStates * NumSymbols + NumSymbols> owner{};
+    for (auto& slot : owner) slot = -1;
+    int size = 0;
+    for (int s : order) {
+        std::array<int, NumSymbols> used{};
+        int num_used = 0;
+        for (int c = 0; c < NumSymbols; ++c) {
+            int r = tables.reduce[s * NumSymbols + c];
+            if (tables.shift[s * NumSymbols + c] >= 0 || (r >= 0 && r != defaults[s])) used[num_used++] = c;
+        }
+        int base = 0;
+        for (bool fits = false; !fits; ) {
+            fits = true;
+            for (int i = 0; i < num_used && fits; ++i) fits = owner[base + used[i]] < 0;
+            if (!fits) ++base;
+        }
+        for (int i = 0; i < num_used; ++i) {
+            int c = used[i];
+            owner[base + c] = int16_t(s);
+            size = std::max(size, base + c + 1);
+            if (!out) continue;
+            int shift = tables.shift[s * NumSymbols + c];
+            out->entries[base + c] = int16_t(shift >= 0 ? shift : -2 - tables.reduce[s * NumSymbols + c]);
+        }
+        if (out) {
+            out->base[s] = int16_t(base);
+            out->default_reduction[s] = int16_t(defaults[s]);
+        }
+    }
+    if (out) {
+        for (int i = 0; i < size; ++i) out->check[i] = owner[i];
+    }
+    return size;
+}
+
+template <int NumSymbols, int NumStates, int NumProductions>
+constexpr int combLrTableSize(const LrTables<NumSymbols, NumStates, NumProductions>& tables) {
+    return packLrTables(tables, static_cast<CombLrTables<NumStates, 1>*>(nullptr));
+}
+
+template <int TableSize, int NumSymbols, int NumStates, int NumProductions>
+constexpr CombLrTables<NumStates, TableSize> compressLrTables(const LrTables<NumSymbols, NumStates, NumProductions>& tables) {
+    CombLrTables<NumStates, TableSize> comb;
+    packLrTables(tables, &comb);
+    return comb;
+}
+
+#endif
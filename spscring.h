@@ -0,0 +1,60 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. Each side keeps a cached copy of the other side's
+// index and only reloads it when the ring looks full (or empty), so the
+// shared indices are touched about once per lap rather than per item.
+template <typename T, size_t Capacity>
+struct SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    std::array<T, Capacity> slots{};
+    // Next slot to read; written by the consumer.
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+    // Next slot to write; written by the producer.
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cached_head = 0;
+    alignas(64) std::atomic<bool> closed{false};
+
+    // Producer side. Waits while the ring is full, and gives up (returning
+    // false) once the consumer has called close().
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        while (t - cached_head == Capacity) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head < Capacity) break;
+            if (closed.load(std::memory_order_relaxed)) return false;
+            std::this_thread::yield();
+        }
+        slots[t & (Capacity - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Waits until an item is available.
+    T pop() {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h != cached_tail) break;
+            std::this_thread::yield();
+        }
+        T value = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Called by the consumer when it stops reading early, so a producer
+    // blocked on a full ring can finish.
+    void close() {
+        closed.store(true, std::memory_order_relaxed);
+    }
+};
+
+#endif
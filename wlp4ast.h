@@ -0,0 +1,256 @@
+#ifndef WLP4AST_H
+#define WLP4AST_H
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Abstract syntax tree for WLP4, built by the parser as it reduces instead
+// of a node for every grammar symbol: unit chains like expr -> term ->
+// factor collapse into their operand, punctuation is dropped, and list
+// rules (statements, dcls, params, args, procedures) grow one list node.
+// Nodes live in one array; children are a sibling-linked list so list
+// rules can append or prepend in constant time. wlp4type --ast reads the
+// printed AST back and checks and types it.
+
+constexpr std::string_view AST_KINDS[] = {
+    "program", "procedure", "main", "params", "dcls", "statements", "args",
+    "int", "int*", "dcl", "dcl-num", "dcl-null", "assign", "if", "while",
+    "println", "putchar", "delete", "compare", "binary", "var", "num", "null",
+    "address", "deref", "new", "call", "getchar",
+};
+constexpr int NUM_AST_KINDS = sizeof(AST_KINDS) / sizeof(AST_KINDS[0]);
+
+constexpr int astKindId(std::string_view name) {
+    for (int i = 0; i < NUM_AST_KINDS; ++i) {
+        if (AST_KINDS[i] == name) return i;
+    }
+    return -1;
+}
+
+// The semantic action of each production. The pattern has one letter per
+// right-hand side symbol: c is a child, t the token that names the node
+// (an identifier, number or operator), - is dropped, and l or L is a list
+// the result is appended or prepended to, which then becomes the value.
+// With no kind the value is the single child itself.
+struct AstRule {
+    std::string_view production;
+    std::string_view kind;
+    std::string_view pattern;
+};
+
+constexpr AstRule AST_RULES[] = {
+    {"start BOF procedures EOF", "", "- c -"},
+    {"procedures procedure procedures", "", "c L"},
+    {"procedures main", "program", "c"},
+    {"procedure INT ID LPAREN params RPAREN LBRACE dcls statements RETURN expr SEMI RBRACE", "procedure", "- t - c - - c c - c - -"},
+    {"main INT WAIN LPAREN dcl COMMA dcl RPAREN LBRACE dcls statements RETURN expr SEMI RBRACE", "main", "- - - c - c - - c c - c - -"},
+    {"params .EMPTY", "params", ""},
+    {"params paramlist", "", "c"},
+    {"paramlist dcl", "params", "c"},
+    {"paramlist dcl COMMA paramlist", "", "c - L"},
+    {"type INT", "int", "-"},
+    {"type INT STAR", "int*", "- -"},
+    {"dcls .EMPTY", "dcls", ""},
+    {"dcls dcls dcl BECOMES NUM SEMI", "dcl-num", "l c - t -"},
+    {"dcls dcls dcl BECOMES NULL SEMI", "dcl-null", "l c - - -"},
+    {"dcl type ID", "dcl", "c t"},
+    {"statements .EMPTY", "statements", ""},
+    {"statements statements statement", "", "l c"},
+    {"statement lvalue BECOMES expr SEMI", "assign", "c - c -"},
+    {"statement IF LPAREN test RPAREN LBRACE statements RBRACE ELSE LBRACE statements RBRACE", "if", "- - c - - c - - - c -"},
+    {"statement WHILE LPAREN test RPAREN LBRACE statements RBRACE", "while", "- - c - - c -"},
+    {"statement PRINTLN LPAREN expr RPAREN SEMI", "println", "- - c - -"},
+    {"statement PUTCHAR LPAREN expr RPAREN SEMI", "putchar", "- - c - -"},
+    {"statement DELETE LBRACK RBRACK expr SEMI", "delete", "- - - c -"},
+    {"test expr EQ expr", "compare", "c t c"},
+    {"test expr NE expr", "compare", "c t c"},
+    {"test expr LT expr", "compare", "c t c"},
+    {"test expr LE expr", "compare", "c t c"},
+    {"test expr GE expr", "compare", "c t c"},
+    {"test expr GT expr", "compare", "c t c"},
+    {"expr term", "", "c"},
+    {"expr expr PLUS term", "binary", "c t c"},
+    {"expr expr MINUS term", "binary", "c t c"},
+    {"term factor", "", "c"},
+    {"term term STAR factor", "binary", "c t c"},
+    {"term term SLASH factor", "binary", "c t c"},
+    {"term term PCT factor", "binary", "c t c"},
+    {"factor ID", "var", "t"},
+    {"factor NUM", "num", "t"},
+    {"factor NULL", "null", "-"},
+    {"factor LPAREN expr RPAREN", "", "- c -"},
+    {"factor AMP lvalue", "address", "- c"},
+    {"factor STAR factor", "deref", "- c"},
+    {"factor NEW INT LBRACK expr RBRACK", "new", "- - - c -"},
+    {"factor ID LPAREN RPAREN", "call", "t - -"},
+    {"factor ID LPAREN arglist RPAREN", "call", "t - c -"},
+    {"factor GETCHAR LPAREN RPAREN", "getchar", "- - -"},
+    {"arglist expr", "args", "c"},
+    {"arglist expr COMMA arglist", "", "c - L"},
+    {"lvalue ID", "var", "t"},
+    {"lvalue STAR factor", "deref", "- c"},
+    {"lvalue LPAREN lvalue RPAREN", "", "- c -"},
+};
+
+constexpr int MAX_AST_CHILDREN = 5;
+
+// An AstRule resolved against a production's right-hand side positions.
+struct AstAction {
+    int kind = -1;
+    int token = -1;
+    std::array<int, MAX_AST_CHILDREN> children{};
+    int num_children = 0;
+    int list = -1;
+    bool prepend = false;
+    bool valid = false;
+};
+
+// Matches every production of tables to its rule. Productions without a
+// rule (as in an experimental grammar) get an invalid action.
+template <typename Tables>
+constexpr auto buildAstActions(const Tables& tables) {
+    std::array<AstAction, std::tuple_size_v<decltype(tables.productions)>> actions{};
+    for (size_t p = 0; p < actions.size(); ++p) {
+        const auto& production = tables.productions[p];
+        for (const AstRule& rule : AST_RULES) {
+            std::string_view text = rule.production;
+            if (!text.starts_with(production.lhs) || text.size() <= production.lhs.size() ||
+                text[production.lhs.size()] != ' ' || text.substr(production.lhs.size() + 1) != production.rhs) continue;
+            AstAction action;
+            action.kind = rule.kind.empty() ? -1 : astKindId(rule.kind);
+            int position = 0;
+            bool valid = rule.kind.empty() || action.kind >= 0;
+            for (char c : rule.pattern) {
+                if (c == ' ') continue;
+                if (c == 'c' && action.num_children < MAX_AST_CHILDREN) action.children[action.num_children++] = position;
+                else if (c == 't') action.token = position;
+                else if (c == 'l' || c == 'L') {
+                    action.list = position;
+                    action.prepend = c == 'L';
+                }
+                else if (c != '-') valid = false;
+                ++position;
+            }
+            if (action.kind < 0 && action.num_children != 1) valid = false;
+            action.valid = valid && position == production.rhs_length;
+            actions[p] = action;
+            break;
+        }
+    }
+    return actions;
+}
+
+struct AstNode {
+    int kind;
+    std::string_view lexeme;
+    int first_child = -1;
+    int last_child = -1;
+    int next_sibling = -1;
+    // Set by wlp4type; printed after " : " when not empty.
+    std::string_view type = {};
+};
+
+struct Ast {
+    std::vector<AstNode> nodes;
+
+    int add(int kind, std::string_view lexeme) {
+        nodes.push_back(AstNode{kind, lexeme});
+        return int(nodes.size()) - 1;
+    }
+
+    void append(int parent, int child) {
+        AstNode& node = nodes[parent];
+        if (node.last_child < 0) node.first_child = child;
+        else nodes[node.last_child].next_sibling = child;
+        node.last_child = child;
+    }
+
+    // Returns the index-th child of node, or -1 if it has fewer.
+    int child(int node, int index) const {
+        int result = nodes[node].first_child;
+        for (; result >= 0 && index > 0; --index) result = nodes[result].next_sibling;
+        return result;
+    }
+
+    void prepend(int parent, int child) {
+        AstNode& node = nodes[parent];
+        nodes[child].next_sibling = node.first_child;
+        node.first_child = child;
+        if (node.last_child < 0) node.last_child = child;
+    }
+
+    // Runs a reduction's action and returns its value. values holds one
+    // value per right-hand side symbol: a node for nonterminals, and for
+    // terminals whatever lexeme() turns into the token's text.
+    template <typename Lexeme>
+    int reduce(const AstAction& action, const int* values, Lexeme lexeme) {
+        int value = -1;
+        if (action.kind < 0) value = values[action.children[0]];
+        else {
+            value = add(action.kind, action.token >= 0 ? lexeme(values[action.token]) : std::string_view());
+            for (int i = 0; i < action.num_children; ++i) append(value, values[action.children[i]]);
+        }
+        if (action.list < 0) return value;
+        if (action.prepend) prepend(values[action.list], value);
+        else append(values[action.list], value);
+        return values[action.list];
+    }
+
+    // Writes one line per node in preorder: its number of children, the
+    // kind, then the naming token's lexeme if there is one. Like the parse
+    // tree's production lines, the counts give the shape without indenting,
+    // so the text stays linear in the number of nodes however deep it is.
+    // After a node come its children and then its next sibling, so both
+    // are pushed, sibling first.
+    void print(std::ostream& out, int root) const {
+        std::vector<int> pending{root};
+        while (!pending.empty()) {
+            int node = pending.back();
+            pending.pop_back();
+            int num_children = 0;
+            for (int c = nodes[node].first_child; c >= 0; c = nodes[c].next_sibling) ++num_children;
+            out << num_children << " " << AST_KINDS[nodes[node].kind];
+            if (!nodes[node].lexeme.empty()) out << " " << nodes[node].lexeme;
+            if (!nodes[node].type.empty()) out << " : " << nodes[node].type;
+            out << "\n";
+            if (node != root && nodes[node].next_sibling >= 0) pending.push_back(nodes[node].next_sibling);
+            if (nodes[node].first_child >= 0) pending.push_back(nodes[node].first_child);
+        }
+    }
+
+    // Reads what print writes, without types, and returns the root, or -1
+    // if text is not such a tree. Lexemes are views into text, which has
+    // to outlive the AST. open holds each node still waiting for children
+    // and how many; a line's parent is the innermost of them.
+    int read(std::string_view text) {
+        std::vector<std::pair<int, size_t>> open;
+        int root = -1;
+        for (size_t line_begin = 0; line_begin < text.size(); ) {
+            size_t line_end = std::min(text.find('\n', line_begin), text.size());
+            std::string_view line = text.substr(line_begin, line_end - line_begin);
+            line_begin = line_end + 1;
+            if (line.find_first_not_of(' ') == std::string_view::npos) continue;
+            size_t num_children = 0;
+            auto [count_end, error] = std::from_chars(line.data(), line.data() + line.size(), num_children);
+            if (error != std::errc() || count_end == line.data() + line.size() || *count_end != ' ') return -1;
+            line.remove_prefix(count_end - line.data() + 1);
+            size_t kind_end = std::min(line.find(' '), line.size());
+            int kind = astKindId(line.substr(0, kind_end));
+            if (kind < 0 || (open.empty() && root >= 0)) return -1;
+            int node = add(kind, line.substr(std::min(kind_end + 1, line.size())));
+            if (open.empty()) root = node;
+            else {
+                append(open.back().first, node);
+                if (--open.back().second == 0) open.pop_back();
+            }
+            if (num_children > 0) open.push_back({node, num_children});
+        }
+        return open.empty() ? root : -1;
+    }
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include<string>
-const std::string WLP4_CFG = R"END(.CFG
+#include<string_view>
+constexpr std::string_view WLP4_CFG = R"END(.CFG
 start BOF procedures EOF
 procedures procedure procedures
 procedures main
@@ -53,7 +54,7 @@ lvalue STAR factor
 lvalue LPAREN lvalue RPAREN
 )END";
 
-const std::string WLP4_TRANSITIONS = R"END(.TRANSITIONS
+constexpr std::string_view WLP4_TRANSITIONS = R"END(.TRANSITIONS
 0 BOF 1
 1 procedures 4
 1 main 3
@@ -522,7 +523,7 @@ const std::string WLP4_TRANSITIONS = R"END(.TRANSITIONS
 138 lvalue 32
 )END";
 
-const std::string WLP4_REDUCTIONS = R"END(.REDUCTIONS
+constexpr std::string_view WLP4_REDUCTIONS = R"END(.REDUCTIONS
 3 2 EOF
 6 1 EOF
 7 0 .ACCEPT
@@ -1011,4 +1012,4 @@ const std::string WLP4_REDUCTIONS = R"END(.REDUCTIONS
 139 18 RBRACE
 )END";
 
-const std::string WLP4_COMBINED = WLP4_CFG+WLP4_TRANSITIONS+WLP4_REDUCTIONS+".END\n";
\ No newline at end of file
+const std::string WLP4_COMBINED = std::string(WLP4_CFG)+std::string(WLP4_TRANSITIONS)+std::string(WLP4_REDUCTIONS)+".END\n";
\ No newline at end of file
@@ -1,49 +1,11 @@
+#include <deque>
 #include <iostream>
 #include <vector>
-#include <sstream>
 #include <unordered_map>
-#include <unordered_set>
 #include <queue>
 #include <stack>
+#include "wlp4tree.h"
 
-struct TreeNode {
-    std::string token;
-    std::string lexeme;
-    int num_children;
-    std::vector<TreeNode*> children;
-    bool type_annotated = false;
-    std::string type_annotation;
-};
-
-void handleExpr(TreeNode* node, int& pushes, bool& ptr);
-void handleTerm(TreeNode* node, int& pushes, bool& ptr);
-void handleFactor(TreeNode* node, int& pushes, bool& ptr);
-void handleLvalues(TreeNode* node, int& pushes, bool& ptr);
-void processStatements(TreeNode* node);
-
-void printParseTree(TreeNode* node) {
-    std::cout << node->token;
-    for (auto it: node->children) {
-        std::cout << " " << it->token;
-    }
-    std::cout << " " << node->lexeme;
-    if (node->type_annotated) {
-        std::cout << " : " << node->type_annotation;
-    }
-    std::cout << std::endl;
-    for (auto it: node->children) {
-        printParseTree(it);
-    }
-}
-
-void deleteNode(TreeNode* node) {
-    for (auto it: node->children) {
-        deleteNode(it);
-    }
-    delete node;
-}
-
-std::unordered_set<std::string> terminals;
 std::unordered_map<std::string, std::string> procedures_map;
 std::unordered_map<std::string, std::unordered_map<std::string, std::pair<int, bool>>> variable_map;
 std::unordered_map<std::string, int> max_frame_ptr;
@@ -75,147 +37,193 @@ std::string incrementString(const std::string &s) {
     return result;
 }
 
-void handleExpr(TreeNode* node, int& pushes, bool& ptr) {
-    if (node->children.size() == 1) {
-        handleTerm(node->children[0], pushes, ptr);
-    }
-    else if (node->children.size() == 3) {
-
-        bool pointer1 = false;
-        handleTerm(node->children[2], pushes, pointer1);
+// The handle* functions generate code for expressions, terms, factors and
+// lvalues. They run off an explicit stack of frames rather than calling
+// each other, so deep expressions cannot overflow the call stack. A step
+// runs its frame up to the next nested handle* call, which it pushes, and
+// returns true once the frame is done. pushes and ptr point at the
+// caller's counters; frames live in a deque, so those stay valid.
+enum CodeKind {CODE_EXPR, CODE_TERM, CODE_FACTOR, CODE_LVALUE};
+
+struct CodeFrame {
+    TreeNode* node;
+    CodeKind kind;
+    int* pushes;
+    bool* ptr;
+    int stage = 0;
+    int inner_pushes = 0;
+    bool pointer1 = false;
+    bool pointer2 = false;
+    TreeNode* arglist = nullptr;
+    int total_args = 0;
+};
 
-        int inner_pushes = 0;
-        bool pointer2 = false;
-        handleExpr(node->children[0], inner_pushes, pointer2);
+using CodeFrames = std::deque<CodeFrame>;
 
-        std::cout << "lw $10, 0($30)" << std::endl;
+bool exprStep(CodeFrame& frame, CodeFrames& frames) {
+    TreeNode* node = frame.node;
+    if (node->children.size() == 1) {
+        if (frame.stage++ > 0) return true;
+        frames.push_back(CodeFrame{node->children[0], CODE_TERM, frame.pushes, frame.ptr});
+        return false;
+    }
+    if (node->children.size() != 3) return true;
+    switch (frame.stage++) {
+    case 0:
+        frames.push_back(CodeFrame{node->children[2], CODE_TERM, frame.pushes, &frame.pointer1});
+        return false;
+    case 1:
+        frames.push_back(CodeFrame{node->children[0], CODE_EXPR, &frame.inner_pushes, &frame.pointer2});
+        return false;
+    }
 
-        std::cout << "lis $9" << std::endl;
-        std::cout << ".word " << inner_pushes * 4 << std::endl;
-        std::cout << "add $30, $30, $9" << std::endl;
+    std::cout << "lw $10, 0($30)" << std::endl;
 
-        std::cout << "lw $11, 0($30)" << std::endl;
+    std::cout << "lis $9" << std::endl;
+    std::cout << ".word " << frame.inner_pushes * 4 << std::endl;
+    std::cout << "add $30, $30, $9" << std::endl;
 
-        if (pointer1 and !pointer2) {
-            std::cout << "mult $10, $4" << std::endl;
-            std::cout << "mflo $10" << std::endl;
-            ptr = true;
-        }
-        else if (pointer2 and !pointer1) {
-            std::cout << "mult $11, $4" << std::endl;
-            std::cout << "mflo $11" << std::endl;
-            ptr = true;
-        }
+    std::cout << "lw $11, 0($30)" << std::endl;
 
-        if (node->children[1]->token == "PLUS") {
-            std::cout << "add $12, $10, $11" << std::endl;
-        }
-        else if (node->children[1]->token == "MINUS") {
-            std::cout << "sub $12, $10, $11" << std::endl;
-        }
+    if (frame.pointer1 and !frame.pointer2) {
+        std::cout << "mult $10, $4" << std::endl;
+        std::cout << "mflo $10" << std::endl;
+        *frame.ptr = true;
+    }
+    else if (frame.pointer2 and !frame.pointer1) {
+        std::cout << "mult $11, $4" << std::endl;
+        std::cout << "mflo $11" << std::endl;
+        *frame.ptr = true;
+    }
 
-        if (pointer1 && pointer2) {
-            std::cout << "div $12, $4" << std::endl;
-            std::cout << "mflo $12" << std::endl;
-        }
+    if (node->children[1]->token == "PLUS") {
+        std::cout << "add $12, $10, $11" << std::endl;
+    }
+    else if (node->children[1]->token == "MINUS") {
+        std::cout << "sub $12, $10, $11" << std::endl;
+    }
 
-        std::cout << "sw $12, -4($30)" << std::endl;
-        std::cout << "sub $30, $30, $4" << std::endl;
-        ++pushes;
+    if (frame.pointer1 && frame.pointer2) {
+        std::cout << "div $12, $4" << std::endl;
+        std::cout << "mflo $12" << std::endl;
     }
+
+    std::cout << "sw $12, -4($30)" << std::endl;
+    std::cout << "sub $30, $30, $4" << std::endl;
+    ++*frame.pushes;
+    return true;
 }
 
 
-void handleTerm(TreeNode* node, int& pushes, bool& ptr) {
+bool termStep(CodeFrame& frame, CodeFrames& frames) {
+    TreeNode* node = frame.node;
     if (node->children.size() == 1) {
-        handleFactor(node->children[0], pushes, ptr);
+        if (frame.stage++ > 0) return true;
+        frames.push_back(CodeFrame{node->children[0], CODE_FACTOR, frame.pushes, frame.ptr});
+        return false;
+    }
+    if (node->children.size() != 3) return true;
+    switch (frame.stage++) {
+    case 0:
+        frames.push_back(CodeFrame{node->children[2], CODE_FACTOR, frame.pushes, frame.ptr});
+        return false;
+    case 1:
+        frames.push_back(CodeFrame{node->children[0], CODE_TERM, &frame.inner_pushes, frame.ptr});
+        return false;
     }
-    else if (node->children.size() == 3) {
-        handleFactor(node->children[2], pushes, ptr);      
-
-        int inner_pushes = 0;
-        handleTerm(node->children[0], inner_pushes, ptr);
-        std::cout << "lw $13, 0($30)" << std::endl;
 
-        std::cout << "lis $9" << std::endl;
-        std::cout << ".word " << inner_pushes * 4 << std::endl;
-        std::cout << "add $30, $30, $9" << std::endl;
+    std::cout << "lw $13, 0($30)" << std::endl;
 
-        std::cout << "lw $14, 0($30)" << std::endl;
+    std::cout << "lis $9" << std::endl;
+    std::cout << ".word " << frame.inner_pushes * 4 << std::endl;
+    std::cout << "add $30, $30, $9" << std::endl;
 
-        if (node->children[1]->token == "STAR") {
-            std::cout << "mult $13, $14" << std::endl;
-            std::cout << "mflo $15" << std::endl;
-        }
-        else if (node->children[1]->token == "SLASH") {
-            std::cout << "div $13, $14" << std::endl;
-            std::cout << "mflo $15" << std::endl;
-        }
-        else if (node->children[1]->token == "PCT") {
-            std::cout << "div $13, $14" << std::endl;
-            std::cout << "mfhi $15" << std::endl;
-        }
+    std::cout << "lw $14, 0($30)" << std::endl;
 
-        std::cout << "sw $15, -4($30)" << std::endl;
-        std::cout << "sub $30, $30, $4" << std::endl; 
-        ++pushes;
+    if (node->children[1]->token == "STAR") {
+        std::cout << "mult $13, $14" << std::endl;
+        std::cout << "mflo $15" << std::endl;
     }
+    else if (node->children[1]->token == "SLASH") {
+        std::cout << "div $13, $14" << std::endl;
+        std::cout << "mflo $15" << std::endl;
+    }
+    else if (node->children[1]->token == "PCT") {
+        std::cout << "div $13, $14" << std::endl;
+        std::cout << "mfhi $15" << std::endl;
+    }
+
+    std::cout << "sw $15, -4($30)" << std::endl;
+    std::cout << "sub $30, $30, $4" << std::endl;
+    ++*frame.pushes;
+    return true;
 }
 
 
-void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
+bool factorStep(CodeFrame& frame, CodeFrames& frames) {
+    TreeNode* node = frame.node;
+    int stage = frame.stage++;
     if (node->children.size() == 1) {
         if (node->children[0]->token == "NUM") {
             std::string num = node->children[0]->lexeme;
             std::cout << "lis $16" << std::endl;
             std::cout << ".word " << num << std::endl;
             std::cout << "sw $16, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl; 
-            ++pushes;
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
         }
 
         else if (node->children[0]->token == "ID") {
             std::cout << "lw $16, " << variable_map[curr_func][node->children[0]->lexeme].first << "($29)" << std::endl;
             std::cout << "sw $16, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl; 
-            ++pushes;
-            ptr = variable_map[curr_func][node->children[0]->lexeme].second;
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
+            *frame.ptr = variable_map[curr_func][node->children[0]->lexeme].second;
         }
 
         else if (node->children[0]->token == "NULL") {
             std::cout << "lis $16" << std::endl;
             std::cout << ".word 1" << std::endl;
             std::cout << "sw $16, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl; 
-            ++pushes;
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
         }
     }
 
     else if (node->children.size() == 2) {
         if (node->children[0]->token == "STAR") {
-            bool ptr2 = true;
-            handleFactor(node->children[1], pushes, ptr2);
+            if (stage == 0) {
+                frame.pointer2 = true;
+                frames.push_back(CodeFrame{node->children[1], CODE_FACTOR, frame.pushes, &frame.pointer2});
+                return false;
+            }
             std::cout << "lw $16, 0($30)" << std::endl;
             std::cout << "lw $17, 0($16)" << std::endl;
             std::cout << "sw $17, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            ++pushes;
-            ptr = false;
+            ++*frame.pushes;
+            *frame.ptr = false;
         }
 
         else if (node->children[0]->token == "AMP") {
-            bool ptr2 = false;
-            handleLvalues(node->children[1], pushes, ptr2);
+            if (stage == 0) {
+                frame.pointer2 = false;
+                frames.push_back(CodeFrame{node->children[1], CODE_LVALUE, frame.pushes, &frame.pointer2});
+                return false;
+            }
             std::cout << "sw $18, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            ++pushes;
-            ptr = true;
+            ++*frame.pushes;
+            *frame.ptr = true;
         }
     }
 
     else if (node->children.size() == 3) {
         if (node->children[0]->token == "LPAREN") {
-            handleExpr(node->children[1], pushes, ptr);
+            if (stage == 0) {
+                frames.push_back(CodeFrame{node->children[1], CODE_EXPR, frame.pushes, frame.ptr});
+                return false;
+            }
         }
         else if (node->children[0]->token == "GETCHAR") {
             std::cout << "lis $5" << std::endl;
@@ -223,7 +231,7 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
             std::cout << "lw $16, 0($5)" << std::endl;
             std::cout << "sw $16, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            ++pushes;
+            ++*frame.pushes;
         }
         else if (node->children[0]->token == "ID") {
             std::cout << "sw $31, -4($30)" << std::endl;
@@ -236,7 +244,7 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
 
             std::cout << "sw $30, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            
+
             std::cout << "lis $26" << std::endl;
             std::cout << ".word " << procedures_map[node->children[0]->lexeme] << std::endl;
             std::cout << "jalr $26" << std::endl;
@@ -250,42 +258,48 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
             std::cout << "lw $29, -8($30)" << std::endl;
 
             std::cout << "sw $3, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl;   
-            ++pushes;  
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
         }
     }
     else if (node->children.size() == 4) {
         if (node->children[0]->token == "ID") {
-            std::cout << "sw $31, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl;
-
-            std::cout << "sw $29, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl;
-
-            TreeNode* arglist = node->children[2];
-            int total_args = 0;
+            // Stage 0 saves the registers; then each argument is one
+            // handleExpr call followed by one pass through here.
+            if (stage == 0) {
+                std::cout << "sw $31, -4($30)" << std::endl;
+                std::cout << "sub $30, $30, $4" << std::endl;
 
-            while (arglist) {
+                std::cout << "sw $29, -4($30)" << std::endl;
+                std::cout << "sub $30, $30, $4" << std::endl;
 
-                int pushes = 0;
-                handleExpr(arglist->children[0], pushes, ptr);
+                frame.arglist = node->children[2];
+                frame.total_args = 0;
+            }
+            else {
                 std::cout << "lw $23, 0($30)" << std::endl;
 
                 std::cout << "lis $9" << std::endl;
-                std::cout << ".word " << pushes * 4 << std::endl;
+                std::cout << ".word " << frame.inner_pushes * 4 << std::endl;
                 std::cout << "add $30, $30, $9" << std::endl;
 
                 std::cout << "sw $23, -4($30)" << std::endl;
                 std::cout << "sub $30, $30, $4" << std::endl;
-                ++total_args;
-                arglist = arglist->children.size() == 1 ? NULL : arglist->children[2];
+                ++frame.total_args;
+                frame.arglist = frame.arglist->children.size() == 1 ? NULL : frame.arglist->children[2];
+            }
+
+            if (frame.arglist) {
+                frame.inner_pushes = 0;
+                frames.push_back(CodeFrame{frame.arglist->children[0], CODE_EXPR, &frame.inner_pushes, frame.ptr});
+                return false;
             }
 
             std::cout << "sub $29, $30, $4" << std::endl;
 
             std::cout << "sw $30, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            
+
             std::cout << "lis $26" << std::endl;
             std::cout << ".word " << procedures_map[node->children[0]->lexeme] << std::endl;
             std::cout << "jalr $26" << std::endl;
@@ -294,7 +308,7 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
 
             std::cout << "lis $26" << std::endl;
 
-            std::cout << ".word " << total_args * 4 + 8 << std::endl;
+            std::cout << ".word " << frame.total_args * 4 + 8 << std::endl;
             std::cout << "add $30, $30, $26" << std::endl;
 
             std::cout << "lw $31, -4($30)" << std::endl;
@@ -302,19 +316,22 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
 
 
             std::cout << "sw $3, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl;  
-            ++pushes;
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
         }
     }
-    
+
     else if (node->children.size() == 5) {
         if (node->children[0]->token == "NEW") {
-            handleExpr(node->children[3], pushes, ptr);
+            if (stage == 0) {
+                frames.push_back(CodeFrame{node->children[3], CODE_EXPR, frame.pushes, frame.ptr});
+                return false;
+            }
             std::cout << "lw $1, 0($30)" << std::endl;
             std::cout << "lis $8" << std::endl;
             std::cout << ".word new" << std::endl;
             std::cout << "sw $31, -4($30)" << std::endl;
-            ++pushes;
+            ++*frame.pushes;
             std::cout << "sub $30, $30, $4" << std::endl;
             std::cout << "add $22, $0, $30" << std::endl;
             std::cout << "jalr $8" << std::endl;
@@ -325,63 +342,77 @@ void handleFactor(TreeNode* node, int& pushes, bool& ptr) {
             std::cout << ".word 1" << std::endl;
             std::cout << "sw $3, -4($30)" << std::endl;
             std::cout << "sub $30, $30, $4" << std::endl;
-            ++pushes;
-            ptr = true;
+            ++*frame.pushes;
+            *frame.ptr = true;
         }
     }
+    return true;
 }
 
 
-void handleLvalues(TreeNode* node, int& pushes, bool& ptr) {
+bool lvalueStep(CodeFrame& frame, CodeFrames& frames) {
+    TreeNode* node = frame.node;
+    int stage = frame.stage++;
     if (node->children.size() == 1) {
         if (node->children[0]->token == "ID") {
             std::cout << "lis $18" << std::endl;
             std::cout << ".word " << variable_map[curr_func][node->children[0]->lexeme].first << std::endl;
             std::cout << "add $18, $18, $29" << std::endl;
             std::cout << "sw $18, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl;  
-            ++pushes;
-            ptr = variable_map[curr_func][node->children[0]->lexeme].second;
-        }   
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
+            *frame.ptr = variable_map[curr_func][node->children[0]->lexeme].second;
+        }
     }
 
     else if (node->children.size() == 2) {
         if (node->children[0]->token == "STAR") {
-            bool ptr2 = true;
-            handleFactor(node->children[1], pushes, ptr2);
+            if (stage == 0) {
+                frame.pointer2 = true;
+                frames.push_back(CodeFrame{node->children[1], CODE_FACTOR, frame.pushes, &frame.pointer2});
+                return false;
+            }
             std::cout << "lw $18, 0($30)" << std::endl;
             std::cout << "sw $18, -4($30)" << std::endl;
-            std::cout << "sub $30, $30, $4" << std::endl; 
-            ++pushes;
-            ptr = true;
+            std::cout << "sub $30, $30, $4" << std::endl;
+            ++*frame.pushes;
+            *frame.ptr = true;
         }
     }
 
     else if (node->children.size() == 3) {
-        if (node->children[0]->token == "LPAREN") {
-            handleLvalues(node->children[1], pushes, ptr);
+        if (node->children[0]->token == "LPAREN" && stage == 0) {
+            frames.push_back(CodeFrame{node->children[1], CODE_LVALUE, frame.pushes, frame.ptr});
+            return false;
         }
     }
+    return true;
 }
 
-void rebuildTree(TreeNode* node) {
-    std::string s;
-    std::getline(std::cin, s);
-    std::istringstream iss{s};
-    std::string child;
-    iss >> node->token;
-    iss >> child;
-    if (terminals.contains(node->token) || child == ".EMPTY") node->lexeme = child;
-    else {++node->num_children; while (!terminals.contains(node->token) && iss >> child && child != ":") ++node->num_children;}
-    if (node->num_children > 0) {
-        for (int i = 0; i < node->num_children; ++i) {
-            TreeNode* child_node = new TreeNode{};
-            rebuildTree(child_node);
-            node->children.emplace_back(child_node);
-        }
+void generateCode(TreeNode* node, CodeKind kind, int& pushes, bool& ptr) {
+    CodeFrames frames;
+    frames.push_back(CodeFrame{node, kind, &pushes, &ptr});
+    while (!frames.empty()) {
+        CodeFrame& frame = frames.back();
+        bool done = false;
+        switch (frame.kind) {
+        case CODE_EXPR: done = exprStep(frame, frames); break;
+        case CODE_TERM: done = termStep(frame, frames); break;
+        case CODE_FACTOR: done = factorStep(frame, frames); break;
+        case CODE_LVALUE: done = lvalueStep(frame, frames); break;
+        }
+        if (done) frames.pop_back();
     }
 }
 
+void handleExpr(TreeNode* node, int& pushes, bool& ptr) {
+    generateCode(node, CODE_EXPR, pushes, ptr);
+}
+
+void handleLvalues(TreeNode* node, int& pushes, bool& ptr) {
+    generateCode(node, CODE_LVALUE, pushes, ptr);
+}
+
 void processReturn(TreeNode* node) {
     int temp = 0;
     bool ptr = false;
@@ -422,27 +453,24 @@ void setupArgs(TreeNode* node) {
     }
 }
 
+// Declarations are placed from the last one down, as the nested dcls
+// spine used to be walked.
 void processDeclarations(TreeNode* node, int offset) {
     if (node->token == "dcls") {
-        if (node->children.size() == 0) {
-            max_frame_ptr[curr_func] = 0;
-            return;
-        }
-        else if (node->children.size() == 5) {
-            if (node->children[3]->token == "NUM") {
-                TreeNode* dcl = node->children[1];
-                TreeNode* num = node->children[3];
+        for (size_t i = node->children.size(); i >= 4; i -= 4) {
+            TreeNode* dcl = node->children[i - 4];
+            TreeNode* value = node->children[i - 2];
+            if (value->token == "NUM") {
                 variable_map[curr_func][dcl->children[1]->lexeme] = std::make_pair(offset, false);
 
                 std::cout << "lis $5" << std::endl;
-                std::cout << ".word " << num->lexeme << std::endl;
+                std::cout << ".word " << value->lexeme << std::endl;
                 std::cout << "sw $5, -4($30)" << std::endl;
                 std::cout << "sub $30, $30, $4" << std::endl;
 
                 offset -= 4;
             }
-            else if (node->children[3]->token == "NULL") {
-                TreeNode* dcl = node->children[1];
+            else if (value->token == "NULL") {
                 variable_map[curr_func][dcl->children[1]->lexeme] = std::make_pair(offset, true);
 
                 std::cout << "lis $5" << std::endl;
@@ -452,8 +480,8 @@ void processDeclarations(TreeNode* node, int offset) {
 
                 offset -= 4;
             }
-            processDeclarations(node->children[0], offset);
         }
+        max_frame_ptr[curr_func] = 0;
     }
 }
 
@@ -538,7 +566,17 @@ void handleTest(TreeNode* node, std::string branch, bool while_loop) {
     }
 }
 
-void handleStatement(TreeNode* node) {
+// Statements are generated off an explicit stack as well, so if and while
+// can nest to any depth. An entry is a statements or statement node, or
+// with no node a line to print once everything before it is done. The
+// bodies of if and while are pushed along with the lines that follow
+// them.
+struct StatementWork {
+    TreeNode* node;
+    std::string text;
+};
+
+void handleStatement(TreeNode* node, std::vector<StatementWork>& pending) {
     if (node->token == "statement") {
         if (node->children.size() == 4) {
             TreeNode* statement = node;
@@ -607,11 +645,11 @@ void handleStatement(TreeNode* node) {
 
             std::cout << branch2 << ":" << std::endl;
             handleTest(node->children[2], branch, true);
-            processStatements(node->children[5]);
-            
-            std::cout << "beq $0, $0, " << branch2 << std::endl;
-            std::cout << branch << ":" << std::endl;
-            
+
+            pending.push_back(StatementWork{nullptr, branch + ":"});
+            pending.push_back(StatementWork{nullptr, "beq $0, $0, " + branch2});
+            pending.push_back(StatementWork{node->children[5], ""});
+
         }
         else if (node->children.size() == 11) {
             
@@ -621,26 +659,25 @@ void handleStatement(TreeNode* node) {
             
             handleTest(node->children[2], branch_2, false);
 
-            processStatements(node->children[9]);
-            std::cout << "beq $0, $0, " << branch_1 << std::endl;
-
-            std::cout << branch_2 << ":" << std::endl;
-            processStatements(node->children[5]);
-
-            std::cout << branch_1 << ":" << std::endl;
+            pending.push_back(StatementWork{nullptr, branch_1 + ":"});
+            pending.push_back(StatementWork{node->children[5], ""});
+            pending.push_back(StatementWork{nullptr, branch_2 + ":"});
+            pending.push_back(StatementWork{nullptr, "beq $0, $0, " + branch_1});
+            pending.push_back(StatementWork{node->children[9], ""});
         }
     }
 }
 
 void processStatements(TreeNode* node) {
-    if (node->token == "statements") {
-        if (node->children.size() == 0) {
-            return;
-        }
-        else if (node->children.size() == 2) {
-            processStatements(node->children[0]);
-            handleStatement(node->children[1]);
-        }
+    std::vector<StatementWork> pending{StatementWork{node, ""}};
+    while (!pending.empty()) {
+        StatementWork work = std::move(pending.back());
+        pending.pop_back();
+        if (!work.node) std::cout << work.text << std::endl;
+        else if (work.node->token == "statements") {
+            for (size_t i = work.node->children.size(); i-- > 0; ) pending.push_back(StatementWork{work.node->children[i], ""});
+        }
+        else handleStatement(work.node, pending);
     }
 }
 void processMain(TreeNode* node) {
@@ -697,12 +734,10 @@ void processProcedure(TreeNode* node) {
     std::cout << "jr $31" << std::endl;
 }
 
+// Main is generated first, then the procedures from the last one back.
 void handleAllProcedures(TreeNode* node) {
-    if (node->children.size() == 1) processMain(node->children[0]);
-    else {
-        handleAllProcedures(node->children[1]);
-        processProcedure(node->children[0]);
-    }
+    processMain(node->children.back());
+    for (size_t i = node->children.size() - 1; i > 0; --i) processProcedure(node->children[i - 1]);
 }
 
 int main() {
@@ -716,24 +751,19 @@ int main() {
     std::cout << "lis $4" << std::endl;
     std::cout << ".word 4" << std::endl;
 
-    terminals.insert("BOF"); terminals.insert("EOF"); terminals.insert("WAIN"); terminals.insert("LPAREN"); terminals.insert("INT"); terminals.insert("COMMA"); terminals.insert("RPAREN"); terminals.insert("LBRACE"); terminals.insert("RETURN"); terminals.insert("SEMI"); terminals.insert("RBRACE"); terminals.insert("STAR"); terminals.insert("ID"), terminals.insert("NUM"); terminals.insert("NULL"); terminals.insert(".EMPTY"); terminals.insert("PLUS"); terminals.insert("MINUS"); terminals.insert("SLASH"); terminals.insert("PCT"); terminals.insert("AMP"); terminals.insert("NEW"); terminals.insert("LBRACK"); terminals.insert("RBRACK"); terminals.insert("BECOMES"); terminals.insert("GETCHAR"); terminals.insert("WHILE"); terminals.insert("PRINTLN"); terminals.insert("PUTCHAR"); terminals.insert("DELETE"); terminals.insert("EQ"); terminals.insert("NE"); terminals.insert("LT"); terminals.insert("LE"); terminals.insert("GE"); terminals.insert("GT"); terminals.insert("IF"); terminals.insert("ELSE");
-
-    TreeNode* head = new TreeNode{};
-    rebuildTree(head);
+    bool flat_lists = false;
+    TreeNode* head = readTree(std::cin, flat_lists);
 
     TreeNode* procedures = head->children[1];
 
-    while (procedures->children.size() != 1){
-        std::string func_name = procedures->children[0]->children[1]->lexeme;
+    for (size_t i = 0; i + 1 < procedures->children.size(); ++i) {
+        std::string func_name = procedures->children[i]->children[1]->lexeme;
         procedures_map[func_name] = "f" + func_name;
-        procedures = procedures->children[1];
     }
 
-    procedures = head->children[1];
-
     handleAllProcedures(procedures);
 
-    deleteNode(head);
+    deleteTree(head);
 
     return 0;
 }
\ No newline at end of file
@@ -1,37 +1,334 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
 #include <utility>
-#include <unordered_map>
 #include <stack>
-#include <sstream>
 #include <vector>
-#include <set>
+#include "lrtables.h"
+#include "wlp4ast.h"
 #include "wlp4data.h"
+#include "spscring.h"
+#include "wlp4scan.h"
+#include "wlp4tokens.h"
+#include <sys/resource.h>
+#if defined(WLP4PARSE_LALR)
+#include "wlp4parse_lalr.h"
+#endif
 
+// Building with -DWLP4PARSE_STATS counts heap allocations for --stats by
+// replacing the global allocator. The array and nothrow forms the library
+// provides go through these, so every allocation is counted. The default
+// build leaves the allocator alone.
+#if defined(WLP4PARSE_STATS)
+std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = size_t(alignment);
+    if (void* p = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+#endif
+
+// The parse tree lives in a few flat arrays and nodes refer to each other
+// by index. A node's children, left to right, are the child_indices run
+// starting at first_child. Names and lexemes are views into the grammar
+// tables, the input buffers or text_arena, so building the tree does no
+// per-node allocation and it is freed all at once with the arrays.
 struct ParseTreeNode {
-    std::string token;
-    std::string lexeme;
-    std::vector<ParseTreeNode*> children;
+    std::string_view token;
+    std::string_view lexeme;
+    int first_child = 0;
+    int num_children = 0;
 };
 
-struct Production {
-    std::string lhs; std::string rhs; int rhs_length;
+// Copies strings into large blocks that are only freed together.
+struct TextArena {
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* next = nullptr;
+    size_t left = 0;
+
+    std::string_view copy(std::string_view text) {
+        if (text.size() > left) {
+            left = std::max(text.size(), BLOCK_SIZE);
+            blocks.emplace_back(new char[left]);
+            next = blocks.back().get();
+        }
+        std::string_view result(next, text.size());
+        std::copy(text.begin(), text.end(), next);
+        next += text.size();
+        left -= text.size();
+        return result;
+    }
 };
 
+std::vector<ParseTreeNode> tree_nodes;
+std::vector<int> child_indices;
+TextArena text_arena;
+
+int addNode(std::string_view token, std::string_view lexeme) {
+    tree_nodes.push_back(ParseTreeNode{token, lexeme, int(child_indices.size()), 0});
+    return int(tree_nodes.size()) - 1;
+}
+
 struct Token {
-    std::string token_type; std::string lexeme; ParseTreeNode* tree_node;
+    int symbol = -1; int tree_node = -1;
 };
 
+// The parse tables are built from wlp4data.h when the parser is compiled;
+// see lrtables.h. Grammar symbols are small integers and every parser
+// step indexes flat [state][symbol] arrays. Building with -DWLP4PARSE_LALR
+// takes the grammar and tables from wlp4parse_lalr.h instead, as written
+// by wlp4parsegen.
+#if defined(WLP4PARSE_LALR)
+constexpr std::string_view PARSE_CFG = LALR_CFG;
+constexpr std::string_view PARSE_TRANSITIONS = LALR_TRANSITIONS;
+constexpr std::string_view PARSE_REDUCTIONS = LALR_REDUCTIONS;
+#else
+constexpr std::string_view PARSE_CFG = WLP4_CFG;
+constexpr std::string_view PARSE_TRANSITIONS = WLP4_TRANSITIONS;
+constexpr std::string_view PARSE_REDUCTIONS = WLP4_REDUCTIONS;
+#endif
+constexpr LrTableSizes lr_sizes = measureLrTables(PARSE_CFG, PARSE_TRANSITIONS, PARSE_REDUCTIONS);
+constexpr int NUM_SYMBOLS = lr_sizes.symbols;
+constexpr int NUM_LR_STATES = lr_sizes.states;
+constexpr int NUM_PRODUCTIONS = lr_sizes.productions;
+constexpr LrTables<NUM_SYMBOLS, NUM_LR_STATES, NUM_PRODUCTIONS> lr =
+    buildLrTables<NUM_SYMBOLS, NUM_LR_STATES, NUM_PRODUCTIONS>(PARSE_CFG, PARSE_TRANSITIONS, PARSE_REDUCTIONS);
+constexpr int bof_symbol = lr.symbolId("BOF");
+constexpr int eof_symbol = lr.symbolId("EOF");
+constexpr int accept_symbol = lr.symbolId(".ACCEPT");
+constexpr std::array<int, NUM_TOKEN_KINDS> kind_symbols = [] {
+    std::array<int, NUM_TOKEN_KINDS> result{};
+    for (int i = 0; i < NUM_TOKEN_KINDS; ++i) result[i] = lr.symbolId(TOKEN_KINDS[i]);
+    return result;
+}();
+static_assert(bof_symbol >= 0 && eof_symbol >= 0 && accept_symbol >= 0, "malformed WLP4 parse tables");
+constexpr int MAX_RHS_LENGTH = [] {
+    int result = 1;
+    for (const LrProduction& production : lr.productions) result = std::max(result, production.rhs_length);
+    return result;
+}();
+
+// Building with -DWLP4PARSE_COMPRESSED looks actions up in comb vectors
+// with default reductions (CombLrTables) instead of the dense arrays.
+#if defined(WLP4PARSE_COMPRESSED)
+constexpr int COMB_TABLE_SIZE = combLrTableSize(lr);
+constexpr CombLrTables<NUM_LR_STATES, COMB_TABLE_SIZE> lr_actions = compressLrTables<COMB_TABLE_SIZE>(lr);
+#else
+constexpr const auto& lr_actions = lr;
+#endif
+
+// With --ast the reductions run the semantic actions from wlp4ast.h and
+// build an AST instead of the parse tree. The tree_node of a nonterminal
+// on the stacks is then its AST node; terminals keep their leaf nodes.
+constexpr auto ast_actions = buildAstActions(lr);
+constexpr bool ast_supported = [] {
+    for (const AstAction& action : ast_actions) {
+        if (!action.valid) return false;
+    }
+    return true;
+}();
+#if !defined(WLP4PARSE_LALR)
+static_assert(ast_supported, "AST_RULES must cover every WLP4 production");
+#endif
+bool build_ast = false;
+Ast ast;
+
+// With --flat the list nonterminals come out flat, in the form wlp4tree.h
+// reads: one statements, dcls or procedures node holding every item in
+// source order instead of a spine with one list node per item. A list
+// stays open while its items are collected on list_items; an open node's
+// first_child is its offset there and num_children is OPEN_LIST or
+// OPEN_REVERSED_LIST. It is sealed into child_indices once a reduction
+// takes it as a child, by which time every list opened after it has been.
+enum ListAction : int8_t {LIST_NONE, LIST_START, LIST_APPEND, LIST_PREPEND};
+constexpr int OPEN_LIST = -1;
+constexpr int OPEN_REVERSED_LIST = -2;
+
+constexpr bool isLeftListSymbol(std::string_view symbol) {
+    return symbol == "statements" || symbol == "dcls";
+}
+
+constexpr bool isRightListSymbol(std::string_view symbol) {
+    return symbol == "procedures";
+}
+
+constexpr std::array<ListAction, NUM_PRODUCTIONS> list_actions = [] {
+    std::array<ListAction, NUM_PRODUCTIONS> result{};
+    for (int p = 0; p < NUM_PRODUCTIONS; ++p) {
+        const LrProduction& production = lr.productions[p];
+        bool left = isLeftListSymbol(production.lhs), right = isRightListSymbol(production.lhs);
+        if (!left && !right) continue;
+        std::string_view rhs = production.rhs;
+        size_t n = production.lhs.size();
+        if (left && rhs.size() > n && rhs.starts_with(production.lhs) && rhs[n] == ' ') result[p] = LIST_APPEND;
+        else if (right && rhs.size() > n && rhs.ends_with(production.lhs) && rhs[rhs.size() - n - 1] == ' ') result[p] = LIST_PREPEND;
+        else result[p] = LIST_START;
+    }
+    return result;
+}();
+bool flat_lists = false;
+std::vector<int> list_items;
+
+void sealList(int index) {
+    ParseTreeNode& node = tree_nodes[index];
+    if (node.num_children >= 0) return;
+    auto begin = list_items.begin() + node.first_child;
+    if (node.num_children == OPEN_REVERSED_LIST) std::reverse(begin, list_items.end());
+    node.first_child = int(child_indices.size());
+    node.num_children = int(list_items.end() - begin);
+    node.lexeme = node.num_children == 0 ? ".EMPTY" : "";
+    child_indices.insert(child_indices.end(), begin, list_items.end());
+    list_items.erase(begin, list_items.end());
+}
+
 int curr_state = 0;
-std::unordered_map<int, Production> productions;
-std::unordered_map<int, std::unordered_map<std::string, int>> transitions;
-std::unordered_map<int, std::unordered_map<std::string, int>> reductions;
-std::set<int> accepting_states;
-std::stack<int> state_stack;
+std::stack<int, std::vector<int>> state_stack;
 int shifted_terminals = 0;
-std::stack<Token> seen;
-std::stack<Token> unseen_inverted;
-std::stack<Token> unseen;
+// Parser steps, terminals and nonterminals alike, for --stats.
+size_t num_shifts = 0;
+size_t num_reductions = 0;
+std::stack<Token, std::vector<Token>> seen;
+// The lookahead token, with the nonterminal of the last reduction on top
+// of it until that is shifted. Input tokens are pulled in one at a time.
+std::stack<Token, std::vector<Token>> unseen;
+
+// With --source the scanner runs on its own thread and hands tokens over
+// through scanned_tokens while the parser is already shifting. A record
+// with kind -1 marks the end of the input.
+struct TokenRecord {
+    int kind; std::string_view lexeme;
+};
+
+SpscRing<TokenRecord, 4096> scanned_tokens;
+bool streaming_input = false;
+bool input_done = false;
 
+// Otherwise the input is either "KIND lexeme" lines or the binary stream
+// written by wlp4scan --binary, told apart by the stream's magic bytes.
+bool binary_input = false;
+TokenStreamReader binary_tokens;
+uint32_t next_binary_token = 0;
+std::string text_line;
+size_t text_pos = 0;
+std::string_view text_lexeme;
+
+// With -j or --reparse the whole input is read into buffered_tokens first,
+// so that the procedures can be parsed on several threads or a part of the
+// input parsed on its own; see parseProcedures and reparse.
+bool buffered_input = false;
+std::vector<Token> buffered_tokens;
+size_t next_buffered_token = 0;
+
+// Joins the scanner thread on every way out of main, unblocking it first
+// if the parser stopped early.
+struct ScannerThread {
+    std::thread thread;
+    ~ScannerThread() {
+        if (!thread.joinable()) return;
+        scanned_tokens.close();
+        thread.join();
+    }
+};
+
+void scanSource(std::string_view source) {
+    scanText(source, [](int kind, std::string_view lexeme) {
+        scanned_tokens.push(TokenRecord{kind, lexeme});
+    }, [](const char* message) { std::cerr << message << std::endl; });
+    scanned_tokens.push(TokenRecord{-1, {}});
+}
+
+// Returns the next whitespace-separated word of text_line, or an empty
+// view at the end of the line.
+std::string_view nextTextWord() {
+    while (text_pos < text_line.size() && std::isspace((unsigned char) text_line[text_pos])) ++text_pos;
+    size_t begin = text_pos;
+    while (text_pos < text_line.size() && !std::isspace((unsigned char) text_line[text_pos])) ++text_pos;
+    return std::string_view(text_line).substr(begin, text_pos - begin);
+}
+
+// Reads the next input token into a new leaf node; returns false at the
+// end of the input.
+bool readToken(Token& next) {
+    if (buffered_input) {
+        if (next_buffered_token == buffered_tokens.size()) return false;
+        next = buffered_tokens[next_buffered_token++];
+        return true;
+    }
+    if (streaming_input) {
+        TokenRecord record = scanned_tokens.pop();
+        if (record.kind < 0) return false;
+        next = Token{kind_symbols[record.kind], addNode(TOKEN_KINDS[record.kind], record.lexeme)};
+        return true;
+    }
+    if (binary_input) {
+        if (next_binary_token == binary_tokens.num_tokens) return false;
+        uint32_t i = next_binary_token++;
+        int kind = binary_tokens.kind(i);
+        next = Token{kind_symbols[kind], addNode(TOKEN_KINDS[kind], binary_tokens.lexeme(i))};
+        return true;
+    }
+    // A line may hold several tokens. A token without a lexeme keeps the
+    // previous lexeme from its line, as the old line-at-a-time reader did.
+    std::string_view token = nextTextWord();
+    while (token.empty()) {
+        if (!std::getline(std::cin, text_line)) return false;
+        text_pos = 0;
+        text_lexeme = {};
+        token = nextTextWord();
+    }
+    if (std::string_view lexeme = nextTextWord(); !lexeme.empty()) text_lexeme = text_arena.copy(lexeme);
+    int symbol = lr.symbolId(token);
+    next = Token{symbol, addNode(symbol >= 0 ? lr.symbol_names[symbol] : text_arena.copy(token), text_lexeme)};
+    return true;
+}
+
+// Puts the next input token, or EOF at the end of the input, on unseen.
+void pullToken() {
+    if (input_done) return;
+    Token next;
+    if (!readToken(next)) {
+        input_done = true;
+        next = Token{eof_symbol, addNode("EOF", "EOF")};
+    }
+    unseen.push(next);
+}
 
 void errorOut() {
     std::cerr << "ERROR at " << shifted_terminals + 1 << std::endl;
@@ -39,142 +336,511 @@ void errorOut() {
 
 void shift(Token next, bool increment_terminal_counter) {
     unseen.pop();
-    int next_state = transitions[curr_state][next.token_type];
+    int next_state = lr_actions.shiftAction(curr_state, next.symbol);
     if (increment_terminal_counter) ++shifted_terminals;
+    ++num_shifts;
     seen.push(next);
     state_stack.push(next_state);
     curr_state = next_state;
 }
 
-void print(ParseTreeNode* node) {
-    if (node->children.empty()) {
-        std::cout << node->token << " " << node -> lexeme << std::endl;
-        return;
+constexpr int procedure_symbol = lr.symbolId("procedure");
+constexpr int int_symbol = lr.symbolId("INT");
+constexpr int id_symbol = lr.symbolId("ID");
+constexpr int lparen_symbol = lr.symbolId("LPAREN");
+constexpr int lbrace_symbol = lr.symbolId("LBRACE");
+constexpr int rbrace_symbol = lr.symbolId("RBRACE");
+
+// A procedure parsed on a worker thread, or a region parsed by --reparse.
+// Its interior nodes are kept apart until it is merged into the tree: a
+// child index c < 0 refers to nodes[-1 - c], others to leaves already in
+// tree_nodes. The root is the last node.
+struct SubtreeParse {
+    std::vector<ParseTreeNode> nodes;
+    std::vector<int> child_indices;
+    size_t shifts = 0;
+    size_t reductions = 0;
+    bool ok = false;
+};
+
+// Parses buffered_tokens[begin, end) from LR state start, with the token
+// after them as lookahead, which is what the sequential parse does with
+// them in that state. Succeeds only if the tokens reduce to exactly one
+// goal symbol without touching the stack below start.
+void parseSubtree(size_t begin, size_t end, int start, int goal, SubtreeParse& out) {
+    std::vector<int> states{start};
+    std::vector<int> nodes;
+    size_t pos = begin;
+    while (true) {
+        int symbol = pos < buffered_tokens.size() ? buffered_tokens[pos].symbol : eof_symbol;
+        int next_state = lr_actions.shiftAction(states.back(), symbol);
+        if (next_state >= 0) {
+            if (pos == end) return;
+            states.push_back(next_state);
+            nodes.push_back(buffered_tokens[pos++].tree_node);
+            ++out.shifts;
+            continue;
+        }
+        int reduction_rule = lr_actions.reduceAction(states.back(), symbol);
+        if (reduction_rule < 0) return;
+        const LrProduction& production = lr.productions[reduction_rule];
+        int num_to_pop = production.rhs_length;
+        if (int(states.size()) <= num_to_pop) return;
+        ++out.reductions;
+        out.nodes.push_back(ParseTreeNode{production.lhs, production.rhs == ".EMPTY" ? ".EMPTY" : "", int(out.child_indices.size()), num_to_pop});
+        out.child_indices.insert(out.child_indices.end(), nodes.end() - num_to_pop, nodes.end());
+        nodes.resize(nodes.size() - num_to_pop);
+        states.resize(states.size() - num_to_pop);
+        if (states.size() == 1 && production.lhs_symbol == goal && pos == end) {
+            out.ok = true;
+            return;
+        }
+        next_state = lr_actions.shiftAction(states.back(), production.lhs_symbol);
+        if (next_state < 0) return;
+        states.push_back(next_state);
+        nodes.push_back(-int(out.nodes.size()));
+        ++out.shifts;
+    }
+}
+
+// Appends a parsed subtree's nodes to the tree and returns its root.
+int mergeSubtree(const SubtreeParse& subtree) {
+    int node_base = int(tree_nodes.size());
+    int child_base = int(child_indices.size());
+    for (ParseTreeNode node : subtree.nodes) {
+        node.first_child += child_base;
+        tree_nodes.push_back(node);
     }
-    int children_length = int((node->children).size());
-    std::cout << node->token;
-    for (int i = children_length; i > 0; --i) {
-        std::cout << " " << node->children[i-1]->token;
+    for (int child : subtree.child_indices) child_indices.push_back(child < 0 ? node_base - 1 - child : child);
+    return int(tree_nodes.size()) - 1;
+}
+
+// Finds the procedures in front of wain by matching braces over the
+// buffered tokens, parses them on jobs threads and then sets up the parser
+// stacks as if BOF and the procedures had been parsed in sequence, so the
+// main loop goes on with wain and builds the procedures spine. Returns
+// false without touching the stacks if the input does not split cleanly
+// into procedures that parse; the caller then parses everything in order,
+// which also reports any error at the right token.
+bool parseProcedures(int jobs) {
+    if (procedure_symbol < 0 || int_symbol < 0 || id_symbol < 0 || lparen_symbol < 0 || lbrace_symbol < 0 || rbrace_symbol < 0) return false;
+    std::vector<std::pair<size_t, size_t>> bounds;
+    size_t pos = 0;
+    const std::vector<Token>& tokens = buffered_tokens;
+    while (pos + 2 < tokens.size() && tokens[pos].symbol == int_symbol && tokens[pos + 1].symbol == id_symbol && tokens[pos + 2].symbol == lparen_symbol) {
+        size_t end = pos + 3;
+        while (end < tokens.size() && tokens[end].symbol != lbrace_symbol) ++end;
+        for (int depth = 0; end < tokens.size(); ++end) {
+            if (tokens[end].symbol == lbrace_symbol) ++depth;
+            else if (tokens[end].symbol == rbrace_symbol && --depth == 0) break;
+        }
+        if (end == tokens.size()) break;
+        bounds.emplace_back(pos, end + 1);
+        pos = end + 1;
     }
-    std::cout << std::endl;
-    for (int i = children_length; i > 0; --i) {
-        print(node->children[i-1]);
+    if (bounds.empty()) return false;
+
+    // The state after BOF and after each procedure; the sequential parse
+    // shifts every procedure in the state left by the one before it.
+    std::vector<int> states{lr_actions.shiftAction(0, bof_symbol)};
+    for (size_t i = 0; i < bounds.size() && states.back() >= 0; ++i) {
+        states.push_back(lr_actions.shiftAction(states.back(), procedure_symbol));
     }
+    if (states.back() < 0) return false;
+
+    std::vector<SubtreeParse> procedures(bounds.size());
+    std::atomic<size_t> next_procedure{0};
+    auto work = [&] {
+        for (size_t i = next_procedure++; i < bounds.size(); i = next_procedure++) {
+            parseSubtree(bounds[i].first, bounds[i].second, states[i], procedure_symbol, procedures[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < jobs; ++i) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+    for (const SubtreeParse& procedure : procedures) {
+        if (!procedure.ok) return false;
+    }
+
+    seen.push(Token{bof_symbol, addNode("BOF", "BOF")});
+    state_stack.push(states[0]);
+    num_shifts += 1 + procedures.size();
+    for (size_t i = 0; i < procedures.size(); ++i) {
+        seen.push(Token{procedure_symbol, mergeSubtree(procedures[i])});
+        state_stack.push(states[i + 1]);
+        num_shifts += procedures[i].shifts;
+        num_reductions += procedures[i].reductions;
+    }
+    curr_state = states.back();
+    shifted_terminals = int(pos);
+    next_buffered_token = pos;
+    return true;
 }
 
-void deleteNode(ParseTreeNode* node) {
-    for (auto child: node->children) deleteNode(child);
-    delete node;
+// With --reparse the tree printed for an earlier version of the input is
+// read as text. The regions it can parse again are the statements,
+// procedures, main and top-level dcls; each has its range of input tokens,
+// counted without BOF and EOF, the LR state it starts in and the lines of
+// the old tree it takes up.
+struct ReparseRegion {
+    int symbol;
+    int state;
+    size_t begin;
+    size_t end;
+    size_t text_begin;
+    size_t text_end;
+};
+
+// A reparsed tree is the old tree's text with the lines of one region
+// replaced by the subtree at root.
+struct ReparsedTree {
+    int root = -1;
+    std::string_view before;
+    std::string_view after;
+};
+
+constexpr int statement_symbol = lr.symbolId("statement");
+constexpr int dcls_symbol = lr.symbolId("dcls");
+constexpr int main_symbol = lr.symbolId("main");
+constexpr std::array<bool, NUM_SYMBOLS> nonterminal_symbols = [] {
+    std::array<bool, NUM_SYMBOLS> result{};
+    for (const LrProduction& production : lr.productions) result[production.lhs_symbol] = true;
+    return result;
+}();
+
+// Splits a line of print's output into its token and the rest: the
+// lexeme of a leaf, or the tokens of the children.
+std::pair<std::string_view, std::string_view> splitTreeLine(std::string_view line) {
+    size_t token_end = std::min(line.find(' '), line.size());
+    return {line.substr(0, token_end), line.substr(std::min(token_end + 1, line.size()))};
 }
 
-void deleteStackNodes() {
-    while (!seen.empty()) {
-        deleteNode(seen.top().tree_node);
-        seen.pop();
+// Parses buffered_tokens by reusing old_tree, the text print wrote for an
+// earlier input in which tokens [edit_begin, edit_end) have since been
+// replaced; any other token that differs widens that range. One pass over
+// the old tree notes every region with the state it starts in, which is
+// the state after the symbols to its left, and compares the leaves with
+// the new tokens. Then the smallest region around the edit is parsed
+// again from its state with parseSubtree, and failing that the next
+// larger. The stack and lookahead after it are what they were, so the
+// rest of the old tree stands. Returns no root if nothing reparses or the
+// old tree is not one this parser printed, leaving the caller to parse
+// everything.
+ReparsedTree reparse(std::string_view old_tree, size_t edit_begin, size_t edit_end) {
+    if (statement_symbol < 0 || dcls_symbol < 0 || main_symbol < 0 || procedure_symbol < 0) return {};
+    edit_begin = std::min(edit_begin, edit_end);
+    size_t new_count = buffered_tokens.size();
+    auto sameToken = [&](size_t new_pos, std::string_view token, std::string_view lexeme) {
+        const ParseTreeNode& leaf = tree_nodes[buffered_tokens[new_pos].tree_node];
+        return leaf.token == token && leaf.lexeme == lexeme;
+    };
+
+    // A node whose children are still being read: the state it starts in,
+    // its state after the children so far and how many are left.
+    struct OpenNode {
+        int symbol;
+        int start;
+        int state;
+        int children_left;
+        size_t begin;
+        size_t text_begin;
+    };
+    std::vector<OpenNode> open;
+    std::vector<ReparseRegion> regions;
+    // The lines of the leaves from edit_end on, compared once the number
+    // of old tokens is known.
+    std::vector<size_t> tail_lines;
+    size_t count = 0;
+    bool read_root = false;
+    for (size_t line_begin = 0; line_begin < old_tree.size(); ) {
+        size_t line_end = std::min(old_tree.find('\n', line_begin), old_tree.size());
+        auto [token, rest] = splitTreeLine(old_tree.substr(line_begin, line_end - line_begin));
+        int symbol = lr.symbolId(token);
+        if (symbol < 0 || (open.empty() && read_root)) return {};
+        read_root = true;
+        int start = open.empty() ? 0 : open.back().state;
+        OpenNode node{symbol, start, start, 0, count, line_begin};
+        if (!nonterminal_symbols[symbol] && symbol != bof_symbol && symbol != eof_symbol) {
+            if (count < edit_begin && (count >= new_count || !sameToken(count, token, rest))) edit_begin = count;
+            if (count >= edit_end) tail_lines.push_back(line_begin);
+            ++count;
+        }
+        line_begin = line_end + 1;
+        if (nonterminal_symbols[symbol] && !rest.empty() && rest != ".EMPTY") {
+            node.children_left = int(std::count(rest.begin(), rest.end(), ' ')) + 1;
+            open.push_back(node);
+            continue;
+        }
+        // Closes the node and every parent it completes.
+        while (true) {
+            int parent_symbol = open.empty() ? -1 : open.back().symbol;
+            if (node.symbol == statement_symbol || node.symbol == procedure_symbol || node.symbol == main_symbol ||
+                (node.symbol == dcls_symbol && (parent_symbol == procedure_symbol || parent_symbol == main_symbol))) {
+                regions.push_back(ReparseRegion{node.symbol, node.start, node.begin, count, node.text_begin, std::min(line_begin, old_tree.size())});
+            }
+            if (open.empty()) break;
+            OpenNode& parent = open.back();
+            parent.state = lr_actions.shiftAction(parent.state, node.symbol);
+            if (parent.state < 0) return {};
+            if (--parent.children_left > 0) break;
+            node = parent;
+            open.pop_back();
+        }
+    }
+    if (!open.empty() || !read_root) return {};
+
+    // Old token i is new token i + new_count - old_count past the edit.
+    size_t old_count = count;
+    edit_end = std::min(edit_end, old_count);
+    edit_begin = std::min(edit_begin, edit_end);
+    for (size_t i = 0; i < tail_lines.size(); ++i) {
+        size_t old_pos = old_count - tail_lines.size() + i;
+        size_t line_end = std::min(old_tree.find('\n', tail_lines[i]), old_tree.size());
+        auto [token, lexeme] = splitTreeLine(old_tree.substr(tail_lines[i], line_end - tail_lines[i]));
+        if (old_pos + new_count < old_count || !sameToken(old_pos + new_count - old_count, token, lexeme)) edit_end = old_pos + 1;
     }
-    while (!unseen.empty()) {
-        deleteNode(unseen.top().tree_node);
-        unseen.pop();
+    if (edit_end + new_count < edit_begin + old_count) return {};
+
+    std::erase_if(regions, [&](const ReparseRegion& region) {
+        return edit_begin < region.begin || region.end < edit_end;
+    });
+    std::stable_sort(regions.begin(), regions.end(), [](const ReparseRegion& a, const ReparseRegion& b) {
+        return a.end - a.begin < b.end - b.begin;
+    });
+    for (const ReparseRegion& region : regions) {
+        SubtreeParse subtree;
+        parseSubtree(region.begin, region.end + new_count - old_count, region.state, region.symbol, subtree);
+        num_shifts += subtree.shifts;
+        num_reductions += subtree.reductions;
+        if (!subtree.ok) continue;
+        shifted_terminals = int(new_count);
+        return ReparsedTree{mergeSubtree(subtree), old_tree.substr(0, region.text_begin), old_tree.substr(region.text_end)};
     }
+    return {};
 }
 
-int main() {
-    std::string s;
-    std::istringstream input{WLP4_COMBINED};
-    if (std::getline(input, s) && s != ".CFG") {
-        std::cerr << "Error: CFG not provided at start of the file!" << std::endl;
-        return 1;
-    }
-    int num_derivations = 0;
-    while (std::getline(input, s) && s != ".TRANSITIONS") {
-        size_t space_position = s.find(' ');
-        std::string lhs; std::string rhs;
-        if (space_position == std::string::npos) {
-            std::cerr << "Error: Production rule does not contain LHS/RHS! String: " << s << std::endl;
-            return 0;
-        }
-        lhs = s.substr(0, space_position);
-        rhs = s.substr(space_position + 1);
-        std::istringstream rhs_counter{rhs};
-        int rhs_length = 0; std::string rhs_counter_str;
-        while (rhs_counter >> rhs_counter_str) if (rhs_counter_str != ".EMPTY") ++rhs_length;
-        productions[num_derivations] = Production{lhs=lhs, rhs=rhs, rhs_length=rhs_length};
-        ++num_derivations;
-    }
-    while (std::getline(input, s) && s != ".REDUCTIONS") {
-        std::istringstream transition_line{s}; int start_state; std::string token; int end_state;
-        transition_line >> start_state; transition_line >> token; transition_line >> end_state;
-        transitions[start_state][token] = end_state;
-    }
-    while (std::getline(input, s) && s != ".END") {
-        std::istringstream reduction_line{s}; int start_state; int cfg_rule; std::string token;
-        reduction_line >> start_state; reduction_line >> cfg_rule; reduction_line >> token;
-        reductions[start_state][token] = cfg_rule;
-        if (!accepting_states.contains(start_state)) accepting_states.insert(start_state);
+// Prints the subtree at root in preorder, off an explicit stack of the
+// nodes still to print, so tree depth is not limited by the call stack.
+void print(int root) {
+    std::vector<int> pending{root};
+    while (!pending.empty()) {
+        const ParseTreeNode& node = tree_nodes[pending.back()];
+        pending.pop_back();
+        if (node.num_children == 0) {
+            std::cout << node.token << " " << node.lexeme << std::endl;
+            continue;
+        }
+        std::cout << node.token;
+        for (int i = 0; i < node.num_children; ++i) {
+            std::cout << " " << tree_nodes[child_indices[node.first_child + i]].token;
+        }
+        std::cout << std::endl;
+        for (int i = node.num_children; i > 0; --i) {
+            pending.push_back(child_indices[node.first_child + i - 1]);
+        }
     }
+}
 
-    std::istream& stdinput = std::cin;
+// Reads a token position for --reparse: decimal digits only.
+bool parseTokenNumber(const char* text, size_t& value) {
+    if (!std::isdigit((unsigned char) text[0])) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno == 0;
+}
 
-    ParseTreeNode* BOF_node = new ParseTreeNode{"BOF", "BOF", std::vector<ParseTreeNode*>()};
-    unseen_inverted.push(Token{"BOF", "BOF", BOF_node});
+// Usage: wlp4parse [-j N] [--ast] [--flat] [--stats]
+//                  [--reparse TREE BEGIN END] [--source [file]]
+// Without --source the input is wlp4scan output, as text or in the binary
+// token stream format. With --source the input is WLP4 source, scanned
+// in-process on a second thread. -j N reads all tokens first and parses
+// the procedures before wain on N threads; the output is the same. --ast
+// prints the AST from wlp4ast.h instead of the parse tree, parsing in
+// sequence; wlp4type --ast checks it. --flat prints the parse tree with
+// flat lists, also parsing in sequence. --stats ends with one line on
+// stderr: terminals, shifts and reductions, the time to read and parse
+// the input, the peak RSS and the heap allocations when built with
+// -DWLP4PARSE_STATS; wlp4parsebench reads it. --reparse TREE BEGIN END
+// takes the tree printed for an earlier version of the input in which
+// tokens BEGIN to END - 1, counted from 0 without BOF, have since been
+// replaced, and parses only the statement, procedure or declarations
+// around them again, or everything if that fails; the output is still the
+// same. It cannot be combined with --ast or --flat.
+int main(int argc, char* argv[]) {
+    const char* source_path = nullptr;
+    int jobs = 1;
+    bool print_stats = false;
+    const char* old_tree_path = nullptr;
+    size_t edit_begin = 0;
+    size_t edit_end = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--source") streaming_input = true;
+        else if (arg == "--ast") build_ast = true;
+        else if (arg == "--flat") flat_lists = true;
+        else if (arg == "--stats") print_stats = true;
+        else if (arg == "--reparse") {
+            if (i + 3 >= argc) {
+                std::cerr << "ERROR: --reparse needs TREE BEGIN END" << std::endl;
+                return 1;
+            }
+            old_tree_path = argv[++i];
+            if (!parseTokenNumber(argv[++i], edit_begin) || !parseTokenNumber(argv[++i], edit_end) || edit_begin > edit_end) {
+                std::cerr << "ERROR: --reparse BEGIN and END must be token numbers with BEGIN <= END" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-j" && i + 1 < argc) jobs = std::max(1, std::atoi(argv[++i]));
+        else if (arg.starts_with("-j")) jobs = std::max(1, std::atoi(argv[i] + 2));
+        else source_path = argv[i];
+    }
+    if (old_tree_path && (build_ast || flat_lists)) {
+        std::cerr << "ERROR: --reparse cannot be combined with --ast or --flat" << std::endl;
+        return 1;
+    }
+    std::istream& stdinput = std::cin;
+    auto start_time = std::chrono::steady_clock::now();
+    if (build_ast && !ast_supported) {
+        std::cerr << "ERROR: --ast needs a semantic action for every production" << std::endl;
+        return 1;
+    }
 
-    while (std::getline(stdinput, s)) {
-       std::istringstream input_text{s}; std::string token; std::string lexeme;
-       while (input_text >> token) {
-            input_text >> lexeme;
-            ParseTreeNode* node = new ParseTreeNode{token, lexeme, std::vector<ParseTreeNode*>()};
-            unseen_inverted.push(Token{token, lexeme, node});
-       }
+    std::string source_text;
+    ScannerThread scanner;
+    if (streaming_input) {
+        std::ifstream source_file;
+        if (source_path) source_file.open(source_path);
+        std::istream& source = source_path ? source_file : stdinput;
+        if (!source) {
+            std::cerr << "ERROR: cannot open " << source_path << std::endl;
+            return 1;
+        }
+        source_text.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+        scanner.thread = std::thread(scanSource, std::string_view(source_text));
     }
 
+    binary_input = !streaming_input && TokenStreamReader::isBinary(stdinput);
+    if (binary_input && !binary_tokens.read(stdinput)) {
+        std::cerr << "ERROR: malformed binary token stream" << std::endl;
+        return 1;
+    }
 
-    ParseTreeNode* EOF_node = new ParseTreeNode{"EOF", "EOF", std::vector<ParseTreeNode*>()};
-    unseen_inverted.push(Token{"EOF", "EOF", EOF_node});
+    std::string old_tree_text;
+    ReparsedTree reparsed;
+    if (old_tree_path) {
+        std::ifstream old_tree_file(old_tree_path, std::ios::binary);
+        if (!old_tree_file) {
+            std::cerr << "ERROR: cannot open " << old_tree_path << std::endl;
+            return 1;
+        }
+        old_tree_file.seekg(0, std::ios::end);
+        old_tree_text.resize(old_tree_file.tellg());
+        old_tree_file.seekg(0);
+        old_tree_file.read(old_tree_text.data(), old_tree_text.size());
+        for (Token next; readToken(next); ) buffered_tokens.push_back(next);
+        buffered_input = true;
+        reparsed = reparse(old_tree_text, edit_begin, edit_end);
+    }
 
-    while (!unseen_inverted.empty()) {
-        unseen.push(unseen_inverted.top());
-        unseen_inverted.pop();
+    int start_node = reparsed.root;
+    bool split = false;
+    if (start_node < 0 && jobs > 1 && !build_ast && !flat_lists) {
+        if (!buffered_input) {
+            for (Token next; readToken(next); ) buffered_tokens.push_back(next);
+            buffered_input = true;
+        }
+        split = parseProcedures(jobs);
     }
+    if (!split && start_node < 0) unseen.push(Token{bof_symbol, addNode("BOF", "BOF")});
 
-    ParseTreeNode* start_node = new ParseTreeNode{"start", "", std::vector<ParseTreeNode*>()};
+    while (start_node < 0) {
+        if (unseen.empty()) pullToken();
+        Token next = !unseen.empty() ? unseen.top() : Token{accept_symbol, -1};
 
-    while (true) {
-        Token next = !unseen.empty() ? unseen.top() : Token{".ACCEPT", ".ACCEPT"};
-
-        if (transitions[curr_state].contains(next.token_type)) {
-            shift(next, (next.token_type != "BOF" && next.token_type != "EOF"));
-        }
-
-        else if (accepting_states.contains(curr_state)) {
-            if (reductions[curr_state].contains(next.token_type)) {
-                int reduction_rule = reductions[curr_state][next.token_type];
-                int num_to_pop = productions[reduction_rule].rhs_length;
-                ParseTreeNode* curr_node = new ParseTreeNode{productions[reduction_rule].lhs, "", std::vector<ParseTreeNode*>()};
-                if (productions[reduction_rule].rhs == ".EMPTY") curr_node->lexeme = ".EMPTY";
-                for (int i = 0; i < num_to_pop; ++i) state_stack.pop();
-                for (int i = 0; i < num_to_pop; ++i) {
-                    if (state_stack.empty()) start_node->children.emplace_back(seen.top().tree_node);
-                    else curr_node->children.emplace_back(seen.top().tree_node);
-                    seen.pop(); 
+        if (lr_actions.shiftAction(curr_state, next.symbol) >= 0) {
+            shift(next, (next.symbol != bof_symbol && next.symbol != eof_symbol));
+        }
+
+        else {
+            int reduction_rule = lr_actions.reduceAction(curr_state, next.symbol);
+            if (reduction_rule >= 0) {
+                const LrProduction& production = lr.productions[reduction_rule];
+                int num_to_pop = production.rhs_length;
+                int curr_node = -1;
+                ++num_reductions;
+                // The values come off the stack right to left.
+                std::array<int, MAX_RHS_LENGTH> values;
+                for (int i = num_to_pop; i > 0; --i) {
+                    values[i - 1] = seen.top().tree_node;
+                    seen.pop();
+                    state_stack.pop();
+                }
+                if (build_ast) {
+                    curr_node = ast.reduce(ast_actions[reduction_rule], values.data(), [](int leaf) { return tree_nodes[leaf].lexeme; });
+                }
+                else if (flat_lists && list_actions[reduction_rule] != LIST_NONE) {
+                    ListAction action = list_actions[reduction_rule];
+                    if (action == LIST_START) {
+                        curr_node = addNode(production.lhs, "");
+                        tree_nodes[curr_node].first_child = int(list_items.size());
+                        if (isRightListSymbol(production.lhs)) {
+                            tree_nodes[curr_node].num_children = OPEN_REVERSED_LIST;
+                            list_items.insert(list_items.end(), std::make_reverse_iterator(values.begin() + num_to_pop), values.rend());
+                        }
+                        else {
+                            tree_nodes[curr_node].num_children = OPEN_LIST;
+                            list_items.insert(list_items.end(), values.begin(), values.begin() + num_to_pop);
+                        }
+                    }
+                    else if (action == LIST_APPEND) {
+                        curr_node = values[0];
+                        list_items.insert(list_items.end(), values.begin() + 1, values.begin() + num_to_pop);
+                    }
+                    else {
+                        curr_node = values[num_to_pop - 1];
+                        list_items.insert(list_items.end(), std::make_reverse_iterator(values.begin() + num_to_pop - 1), values.rend());
+                    }
+                }
+                else {
+                    if (flat_lists) {
+                        for (int i = num_to_pop; i > 0; --i) sealList(values[i - 1]);
+                    }
+                    curr_node = addNode(production.lhs, production.rhs == ".EMPTY" ? ".EMPTY" : "");
+                    tree_nodes[curr_node].num_children = num_to_pop;
+                    child_indices.insert(child_indices.end(), values.begin(), values.begin() + num_to_pop);
                 }
                 if (state_stack.empty()) {
-                    seen.push(Token{productions[reduction_rule].lhs, ""});
-                    delete curr_node;
+                    start_node = curr_node;
                     break;
                 }
-                unseen.push(Token{productions[reduction_rule].lhs, "", curr_node});
+                unseen.push(Token{production.lhs_symbol, curr_node});
                 curr_state = state_stack.top();
-                if (!transitions[curr_state].contains(unseen.top().token_type)) {deleteStackNodes(); if (start_node) delete start_node; errorOut(); return 1;}
+                if (lr_actions.shiftAction(curr_state, unseen.top().symbol) < 0) {errorOut(); return 1;}
                 shift(unseen.top(), false);
             }
-            else {deleteStackNodes(); if (start_node) delete start_node; errorOut(); return 1;}
+            else {errorOut(); return 1;}
         }
 
-        else {deleteStackNodes(); if (start_node) delete start_node; errorOut(); return 1;}
-
     }
+    double parse_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
 
-    print(start_node);
+    if (build_ast) ast.print(std::cout, start_node);
+    else {
+        std::cout << reparsed.before;
+        print(start_node);
+        std::cout << reparsed.after;
+    }
 
-    deleteNode(start_node);
-}
\ No newline at end of file
+    if (print_stats) {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        std::fprintf(stderr, "stats: terminals %d shifts %zu reductions %zu parse_seconds %.6f peak_rss_kb %ld",
+                     shifted_terminals, num_shifts, num_reductions, parse_seconds, usage.ru_maxrss);
+#if defined(WLP4PARSE_STATS)
+        std::fprintf(stderr, " allocations %zu", allocations.load());
+#endif
+        std::fprintf(stderr, "\n");
+    }
+}
@@ -0,0 +1,1013 @@
+// Generated by wlp4parsegen. Do not edit.
+#ifndef WLP4PARSE_LALR_H
+#define WLP4PARSE_LALR_H
+#include <string_view>
+
+constexpr std::string_view LALR_CFG = R"END(.CFG
+start BOF procedures EOF
+procedures procedure procedures
+procedures main
+procedure INT ID LPAREN params RPAREN LBRACE dcls statements RETURN expr SEMI RBRACE
+main INT WAIN LPAREN dcl COMMA dcl RPAREN LBRACE dcls statements RETURN expr SEMI RBRACE
+params .EMPTY
+params paramlist
+paramlist dcl
+paramlist dcl COMMA paramlist
+type INT
+type INT STAR
+dcls .EMPTY
+dcls dcls dcl BECOMES NUM SEMI
+dcls dcls dcl BECOMES NULL SEMI
+dcl type ID
+statements .EMPTY
+statements statements statement
+statement lvalue BECOMES expr SEMI
+statement IF LPAREN test RPAREN LBRACE statements RBRACE ELSE LBRACE statements RBRACE
+statement WHILE LPAREN test RPAREN LBRACE statements RBRACE
+statement PRINTLN LPAREN expr RPAREN SEMI
+statement PUTCHAR LPAREN expr RPAREN SEMI
+statement DELETE LBRACK RBRACK expr SEMI
+test expr EQ expr
+test expr NE expr
+test expr LT expr
+test expr LE expr
+test expr GE expr
+test expr GT expr
+expr term
+expr expr PLUS term
+expr expr MINUS term
+term factor
+term term STAR factor
+term term SLASH factor
+term term PCT factor
+factor ID
+factor NUM
+factor NULL
+factor LPAREN expr RPAREN
+factor AMP lvalue
+factor STAR factor
+factor NEW INT LBRACK expr RBRACK
+factor ID LPAREN RPAREN
+factor ID LPAREN arglist RPAREN
+factor GETCHAR LPAREN RPAREN
+arglist expr
+arglist expr COMMA arglist
+lvalue ID
+lvalue STAR factor
+lvalue LPAREN lvalue RPAREN
+)END";
+
+constexpr std::string_view LALR_TRANSITIONS = R"END(.TRANSITIONS
+0 BOF 1
+1 procedures 2
+1 procedure 3
+1 main 4
+1 INT 5
+2 EOF 6
+3 procedures 7
+3 procedure 3
+3 main 4
+3 INT 5
+5 ID 8
+5 WAIN 9
+8 LPAREN 10
+9 LPAREN 11
+10 INT 12
+10 params 13
+10 dcl 14
+10 paramlist 15
+10 type 16
+11 INT 12
+11 dcl 17
+11 type 16
+12 STAR 18
+13 RPAREN 19
+14 COMMA 20
+16 ID 21
+17 COMMA 22
+19 LBRACE 23
+20 INT 12
+20 dcl 14
+20 paramlist 24
+20 type 16
+22 INT 12
+22 dcl 25
+22 type 16
+23 dcls 26
+25 RPAREN 27
+26 INT 12
+26 statements 28
+26 dcl 29
+26 type 16
+27 LBRACE 30
+28 ID 31
+28 LPAREN 32
+28 RETURN 33
+28 STAR 34
+28 statement 35
+28 lvalue 36
+28 IF 37
+28 WHILE 38
+28 PRINTLN 39
+28 PUTCHAR 40
+28 DELETE 41
+29 BECOMES 42
+30 dcls 43
+32 ID 31
+32 LPAREN 32
+32 STAR 34
+32 lvalue 44
+33 ID 45
+33 LPAREN 46
+33 expr 47
+33 STAR 48
+33 NUM 49
+33 NULL 50
+33 term 51
+33 factor 52
+33 AMP 53
+33 NEW 54
+33 GETCHAR 55
+34 ID 45
+34 LPAREN 46
+34 STAR 48
+34 NUM 49
+34 NULL 50
+34 factor 56
+34 AMP 53
+34 NEW 54
+34 GETCHAR 55
+36 BECOMES 57
+37 LPAREN 58
+38 LPAREN 59
+39 LPAREN 60
+40 LPAREN 61
+41 LBRACK 62
+42 NUM 63
+42 NULL 64
+43 INT 12
+43 statements 65
+43 dcl 29
+43 type 16
+44 RPAREN 66
+45 LPAREN 67
+46 ID 45
+46 LPAREN 46
+46 expr 68
+46 STAR 48
+46 NUM 49
+46 NULL 50
+46 term 51
+46 factor 52
+46 AMP 53
+46 NEW 54
+46 GETCHAR 55
+47 SEMI 69
+47 PLUS 70
+47 MINUS 71
+48 ID 45
+48 LPAREN 46
+48 STAR 48
+48 NUM 49
+48 NULL 50
+48 factor 72
+48 AMP 53
+48 NEW 54
+48 GETCHAR 55
+51 STAR 73
+51 SLASH 74
+51 PCT 75
+53 ID 31
+53 LPAREN 32
+53 STAR 34
+53 lvalue 76
+54 INT 77
+55 LPAREN 78
+57 ID 45
+57 LPAREN 46
+57 expr 79
+57 STAR 48
+57 NUM 49
+57 NULL 50
+57 term 51
+57 factor 52
+57 AMP 53
+57 NEW 54
+57 GETCHAR 55
+58 ID 45
+58 LPAREN 46
+58 expr 80
+58 STAR 48
+58 NUM 49
+58 NULL 50
+58 test 81
+58 term 51
+58 factor 52
+58 AMP 53
+58 NEW 54
+58 GETCHAR 55
+59 ID 45
+59 LPAREN 46
+59 expr 80
+59 STAR 48
+59 NUM 49
+59 NULL 50
+59 test 82
+59 term 51
+59 factor 52
+59 AMP 53
+59 NEW 54
+59 GETCHAR 55
+60 ID 45
+60 LPAREN 46
+60 expr 83
+60 STAR 48
+60 NUM 49
+60 NULL 50
+60 term 51
+60 factor 52
+60 AMP 53
+60 NEW 54
+60 GETCHAR 55
+61 ID 45
+61 LPAREN 46
+61 expr 84
+61 STAR 48
+61 NUM 49
+61 NULL 50
+61 term 51
+61 factor 52
+61 AMP 53
+61 NEW 54
+61 GETCHAR 55
+62 RBRACK 85
+63 SEMI 86
+64 SEMI 87
+65 ID 31
+65 LPAREN 32
+65 RETURN 88
+65 STAR 34
+65 statement 35
+65 lvalue 36
+65 IF 37
+65 WHILE 38
+65 PRINTLN 39
+65 PUTCHAR 40
+65 DELETE 41
+67 ID 45
+67 LPAREN 46
+67 RPAREN 89
+67 expr 90
+67 STAR 48
+67 NUM 49
+67 NULL 50
+67 term 51
+67 factor 52
+67 AMP 53
+67 NEW 54
+67 arglist 91
+67 GETCHAR 55
+68 RPAREN 92
+68 PLUS 70
+68 MINUS 71
+69 RBRACE 93
+70 ID 45
+70 LPAREN 46
+70 STAR 48
+70 NUM 49
+70 NULL 50
+70 term 94
+70 factor 52
+70 AMP 53
+70 NEW 54
+70 GETCHAR 55
+71 ID 45
+71 LPAREN 46
+71 STAR 48
+71 NUM 49
+71 NULL 50
+71 term 95
+71 factor 52
+71 AMP 53
+71 NEW 54
+71 GETCHAR 55
+73 ID 45
+73 LPAREN 46
+73 STAR 48
+73 NUM 49
+73 NULL 50
+73 factor 96
+73 AMP 53
+73 NEW 54
+73 GETCHAR 55
+74 ID 45
+74 LPAREN 46
+74 STAR 48
+74 NUM 49
+74 NULL 50
+74 factor 97
+74 AMP 53
+74 NEW 54
+74 GETCHAR 55
+75 ID 45
+75 LPAREN 46
+75 STAR 48
+75 NUM 49
+75 NULL 50
+75 factor 98
+75 AMP 53
+75 NEW 54
+75 GETCHAR 55
+77 LBRACK 99
+78 RPAREN 100
+79 SEMI 101
+79 PLUS 70
+79 MINUS 71
+80 EQ 102
+80 NE 103
+80 LT 104
+80 LE 105
+80 GE 106
+80 GT 107
+80 PLUS 70
+80 MINUS 71
+81 RPAREN 108
+82 RPAREN 109
+83 RPAREN 110
+83 PLUS 70
+83 MINUS 71
+84 RPAREN 111
+84 PLUS 70
+84 MINUS 71
+85 ID 45
+85 LPAREN 46
+85 expr 112
+85 STAR 48
+85 NUM 49
+85 NULL 50
+85 term 51
+85 factor 52
+85 AMP 53
+85 NEW 54
+85 GETCHAR 55
+88 ID 45
+88 LPAREN 46
+88 expr 113
+88 STAR 48
+88 NUM 49
+88 NULL 50
+88 term 51
+88 factor 52
+88 AMP 53
+88 NEW 54
+88 GETCHAR 55
+90 COMMA 114
+90 PLUS 70
+90 MINUS 71
+91 RPAREN 115
+94 STAR 73
+94 SLASH 74
+94 PCT 75
+95 STAR 73
+95 SLASH 74
+95 PCT 75
+99 ID 45
+99 LPAREN 46
+99 expr 116
+99 STAR 48
+99 NUM 49
+99 NULL 50
+99 term 51
+99 factor 52
+99 AMP 53
+99 NEW 54
+99 GETCHAR 55
+102 ID 45
+102 LPAREN 46
+102 expr 117
+102 STAR 48
+102 NUM 49
+102 NULL 50
+102 term 51
+102 factor 52
+102 AMP 53
+102 NEW 54
+102 GETCHAR 55
+103 ID 45
+103 LPAREN 46
+103 expr 118
+103 STAR 48
+103 NUM 49
+103 NULL 50
+103 term 51
+103 factor 52
+103 AMP 53
+103 NEW 54
+103 GETCHAR 55
+104 ID 45
+104 LPAREN 46
+104 expr 119
+104 STAR 48
+104 NUM 49
+104 NULL 50
+104 term 51
+104 factor 52
+104 AMP 53
+104 NEW 54
+104 GETCHAR 55
+105 ID 45
+105 LPAREN 46
+105 expr 120
+105 STAR 48
+105 NUM 49
+105 NULL 50
+105 term 51
+105 factor 52
+105 AMP 53
+105 NEW 54
+105 GETCHAR 55
+106 ID 45
+106 LPAREN 46
+106 expr 121
+106 STAR 48
+106 NUM 49
+106 NULL 50
+106 term 51
+106 factor 52
+106 AMP 53
+106 NEW 54
+106 GETCHAR 55
+107 ID 45
+107 LPAREN 46
+107 expr 122
+107 STAR 48
+107 NUM 49
+107 NULL 50
+107 term 51
+107 factor 52
+107 AMP 53
+107 NEW 54
+107 GETCHAR 55
+108 LBRACE 123
+109 LBRACE 124
+110 SEMI 125
+111 SEMI 126
+112 SEMI 127
+112 PLUS 70
+112 MINUS 71
+113 SEMI 128
+113 PLUS 70
+113 MINUS 71
+114 ID 45
+114 LPAREN 46
+114 expr 90
+114 STAR 48
+114 NUM 49
+114 NULL 50
+114 term 51
+114 factor 52
+114 AMP 53
+114 NEW 54
+114 arglist 129
+114 GETCHAR 55
+116 RBRACK 130
+116 PLUS 70
+116 MINUS 71
+117 PLUS 70
+117 MINUS 71
+118 PLUS 70
+118 MINUS 71
+119 PLUS 70
+119 MINUS 71
+120 PLUS 70
+120 MINUS 71
+121 PLUS 70
+121 MINUS 71
+122 PLUS 70
+122 MINUS 71
+123 statements 131
+124 statements 132
+128 RBRACE 133
+131 ID 31
+131 LPAREN 32
+131 RBRACE 134
+131 STAR 34
+131 statement 35
+131 lvalue 36
+131 IF 37
+131 WHILE 38
+131 PRINTLN 39
+131 PUTCHAR 40
+131 DELETE 41
+132 ID 31
+132 LPAREN 32
+132 RBRACE 135
+132 STAR 34
+132 statement 35
+132 lvalue 36
+132 IF 37
+132 WHILE 38
+132 PRINTLN 39
+132 PUTCHAR 40
+132 DELETE 41
+134 ELSE 136
+136 LBRACE 137
+137 statements 138
+138 ID 31
+138 LPAREN 32
+138 RBRACE 139
+138 STAR 34
+138 statement 35
+138 lvalue 36
+138 IF 37
+138 WHILE 38
+138 PRINTLN 39
+138 PUTCHAR 40
+138 DELETE 41
+)END";
+
+constexpr std::string_view LALR_REDUCTIONS = R"END(.REDUCTIONS
+4 2 EOF
+6 0 .ACCEPT
+7 1 EOF
+10 5 RPAREN
+12 9 ID
+14 7 RPAREN
+15 6 RPAREN
+18 10 ID
+21 14 RPAREN
+21 14 COMMA
+21 14 BECOMES
+23 11 INT
+23 11 ID
+23 11 LPAREN
+23 11 RETURN
+23 11 STAR
+23 11 IF
+23 11 WHILE
+23 11 PRINTLN
+23 11 PUTCHAR
+23 11 DELETE
+24 8 RPAREN
+26 15 ID
+26 15 LPAREN
+26 15 RETURN
+26 15 STAR
+26 15 IF
+26 15 WHILE
+26 15 PRINTLN
+26 15 PUTCHAR
+26 15 DELETE
+30 11 INT
+30 11 ID
+30 11 LPAREN
+30 11 RETURN
+30 11 STAR
+30 11 IF
+30 11 WHILE
+30 11 PRINTLN
+30 11 PUTCHAR
+30 11 DELETE
+31 48 RPAREN
+31 48 SEMI
+31 48 COMMA
+31 48 STAR
+31 48 BECOMES
+31 48 RBRACK
+31 48 EQ
+31 48 NE
+31 48 LT
+31 48 LE
+31 48 GE
+31 48 GT
+31 48 PLUS
+31 48 MINUS
+31 48 SLASH
+31 48 PCT
+35 16 ID
+35 16 LPAREN
+35 16 RETURN
+35 16 RBRACE
+35 16 STAR
+35 16 IF
+35 16 WHILE
+35 16 PRINTLN
+35 16 PUTCHAR
+35 16 DELETE
+43 15 ID
+43 15 LPAREN
+43 15 RETURN
+43 15 STAR
+43 15 IF
+43 15 WHILE
+43 15 PRINTLN
+43 15 PUTCHAR
+43 15 DELETE
+45 36 RPAREN
+45 36 SEMI
+45 36 COMMA
+45 36 STAR
+45 36 BECOMES
+45 36 RBRACK
+45 36 EQ
+45 36 NE
+45 36 LT
+45 36 LE
+45 36 GE
+45 36 GT
+45 36 PLUS
+45 36 MINUS
+45 36 SLASH
+45 36 PCT
+49 37 RPAREN
+49 37 SEMI
+49 37 COMMA
+49 37 STAR
+49 37 BECOMES
+49 37 RBRACK
+49 37 EQ
+49 37 NE
+49 37 LT
+49 37 LE
+49 37 GE
+49 37 GT
+49 37 PLUS
+49 37 MINUS
+49 37 SLASH
+49 37 PCT
+50 38 RPAREN
+50 38 SEMI
+50 38 COMMA
+50 38 STAR
+50 38 BECOMES
+50 38 RBRACK
+50 38 EQ
+50 38 NE
+50 38 LT
+50 38 LE
+50 38 GE
+50 38 GT
+50 38 PLUS
+50 38 MINUS
+50 38 SLASH
+50 38 PCT
+51 29 RPAREN
+51 29 SEMI
+51 29 COMMA
+51 29 RBRACK
+51 29 EQ
+51 29 NE
+51 29 LT
+51 29 LE
+51 29 GE
+51 29 GT
+51 29 PLUS
+51 29 MINUS
+52 32 RPAREN
+52 32 SEMI
+52 32 COMMA
+52 32 STAR
+52 32 RBRACK
+52 32 EQ
+52 32 NE
+52 32 LT
+52 32 LE
+52 32 GE
+52 32 GT
+52 32 PLUS
+52 32 MINUS
+52 32 SLASH
+52 32 PCT
+56 49 RPAREN
+56 49 SEMI
+56 49 COMMA
+56 49 STAR
+56 49 BECOMES
+56 49 RBRACK
+56 49 EQ
+56 49 NE
+56 49 LT
+56 49 LE
+56 49 GE
+56 49 GT
+56 49 PLUS
+56 49 MINUS
+56 49 SLASH
+56 49 PCT
+66 50 RPAREN
+66 50 SEMI
+66 50 COMMA
+66 50 STAR
+66 50 BECOMES
+66 50 RBRACK
+66 50 EQ
+66 50 NE
+66 50 LT
+66 50 LE
+66 50 GE
+66 50 GT
+66 50 PLUS
+66 50 MINUS
+66 50 SLASH
+66 50 PCT
+72 41 RPAREN
+72 41 SEMI
+72 41 COMMA
+72 41 STAR
+72 41 BECOMES
+72 41 RBRACK
+72 41 EQ
+72 41 NE
+72 41 LT
+72 41 LE
+72 41 GE
+72 41 GT
+72 41 PLUS
+72 41 MINUS
+72 41 SLASH
+72 41 PCT
+76 40 RPAREN
+76 40 SEMI
+76 40 COMMA
+76 40 STAR
+76 40 BECOMES
+76 40 RBRACK
+76 40 EQ
+76 40 NE
+76 40 LT
+76 40 LE
+76 40 GE
+76 40 GT
+76 40 PLUS
+76 40 MINUS
+76 40 SLASH
+76 40 PCT
+86 12 INT
+86 12 ID
+86 12 LPAREN
+86 12 RETURN
+86 12 STAR
+86 12 IF
+86 12 WHILE
+86 12 PRINTLN
+86 12 PUTCHAR
+86 12 DELETE
+87 13 INT
+87 13 ID
+87 13 LPAREN
+87 13 RETURN
+87 13 STAR
+87 13 IF
+87 13 WHILE
+87 13 PRINTLN
+87 13 PUTCHAR
+87 13 DELETE
+89 43 RPAREN
+89 43 SEMI
+89 43 COMMA
+89 43 STAR
+89 43 BECOMES
+89 43 RBRACK
+89 43 EQ
+89 43 NE
+89 43 LT
+89 43 LE
+89 43 GE
+89 43 GT
+89 43 PLUS
+89 43 MINUS
+89 43 SLASH
+89 43 PCT
+90 46 RPAREN
+92 39 RPAREN
+92 39 SEMI
+92 39 COMMA
+92 39 STAR
+92 39 BECOMES
+92 39 RBRACK
+92 39 EQ
+92 39 NE
+92 39 LT
+92 39 LE
+92 39 GE
+92 39 GT
+92 39 PLUS
+92 39 MINUS
+92 39 SLASH
+92 39 PCT
+93 3 INT
+94 30 RPAREN
+94 30 SEMI
+94 30 COMMA
+94 30 RBRACK
+94 30 EQ
+94 30 NE
+94 30 LT
+94 30 LE
+94 30 GE
+94 30 GT
+94 30 PLUS
+94 30 MINUS
+95 31 RPAREN
+95 31 SEMI
+95 31 COMMA
+95 31 RBRACK
+95 31 EQ
+95 31 NE
+95 31 LT
+95 31 LE
+95 31 GE
+95 31 GT
+95 31 PLUS
+95 31 MINUS
+96 33 RPAREN
+96 33 SEMI
+96 33 COMMA
+96 33 STAR
+96 33 RBRACK
+96 33 EQ
+96 33 NE
+96 33 LT
+96 33 LE
+96 33 GE
+96 33 GT
+96 33 PLUS
+96 33 MINUS
+96 33 SLASH
+96 33 PCT
+97 34 RPAREN
+97 34 SEMI
+97 34 COMMA
+97 34 STAR
+97 34 RBRACK
+97 34 EQ
+97 34 NE
+97 34 LT
+97 34 LE
+97 34 GE
+97 34 GT
+97 34 PLUS
+97 34 MINUS
+97 34 SLASH
+97 34 PCT
+98 35 RPAREN
+98 35 SEMI
+98 35 COMMA
+98 35 STAR
+98 35 RBRACK
+98 35 EQ
+98 35 NE
+98 35 LT
+98 35 LE
+98 35 GE
+98 35 GT
+98 35 PLUS
+98 35 MINUS
+98 35 SLASH
+98 35 PCT
+100 45 RPAREN
+100 45 SEMI
+100 45 COMMA
+100 45 STAR
+100 45 BECOMES
+100 45 RBRACK
+100 45 EQ
+100 45 NE
+100 45 LT
+100 45 LE
+100 45 GE
+100 45 GT
+100 45 PLUS
+100 45 MINUS
+100 45 SLASH
+100 45 PCT
+101 17 ID
+101 17 LPAREN
+101 17 RETURN
+101 17 RBRACE
+101 17 STAR
+101 17 IF
+101 17 WHILE
+101 17 PRINTLN
+101 17 PUTCHAR
+101 17 DELETE
+115 44 RPAREN
+115 44 SEMI
+115 44 COMMA
+115 44 STAR
+115 44 BECOMES
+115 44 RBRACK
+115 44 EQ
+115 44 NE
+115 44 LT
+115 44 LE
+115 44 GE
+115 44 GT
+115 44 PLUS
+115 44 MINUS
+115 44 SLASH
+115 44 PCT
+117 23 RPAREN
+118 24 RPAREN
+119 25 RPAREN
+120 26 RPAREN
+121 27 RPAREN
+122 28 RPAREN
+123 15 ID
+123 15 LPAREN
+123 15 RBRACE
+123 15 STAR
+123 15 IF
+123 15 WHILE
+123 15 PRINTLN
+123 15 PUTCHAR
+123 15 DELETE
+124 15 ID
+124 15 LPAREN
+124 15 RBRACE
+124 15 STAR
+124 15 IF
+124 15 WHILE
+124 15 PRINTLN
+124 15 PUTCHAR
+124 15 DELETE
+125 20 ID
+125 20 LPAREN
+125 20 RETURN
+125 20 RBRACE
+125 20 STAR
+125 20 IF
+125 20 WHILE
+125 20 PRINTLN
+125 20 PUTCHAR
+125 20 DELETE
+126 21 ID
+126 21 LPAREN
+126 21 RETURN
+126 21 RBRACE
+126 21 STAR
+126 21 IF
+126 21 WHILE
+126 21 PRINTLN
+126 21 PUTCHAR
+126 21 DELETE
+127 22 ID
+127 22 LPAREN
+127 22 RETURN
+127 22 RBRACE
+127 22 STAR
+127 22 IF
+127 22 WHILE
+127 22 PRINTLN
+127 22 PUTCHAR
+127 22 DELETE
+129 47 RPAREN
+130 42 RPAREN
+130 42 SEMI
+130 42 COMMA
+130 42 STAR
+130 42 BECOMES
+130 42 RBRACK
+130 42 EQ
+130 42 NE
+130 42 LT
+130 42 LE
+130 42 GE
+130 42 GT
+130 42 PLUS
+130 42 MINUS
+130 42 SLASH
+130 42 PCT
+133 4 EOF
+135 19 ID
+135 19 LPAREN
+135 19 RETURN
+135 19 RBRACE
+135 19 STAR
+135 19 IF
+135 19 WHILE
+135 19 PRINTLN
+135 19 PUTCHAR
+135 19 DELETE
+137 15 ID
+137 15 LPAREN
+137 15 RBRACE
+137 15 STAR
+137 15 IF
+137 15 WHILE
+137 15 PRINTLN
+137 15 PUTCHAR
+137 15 DELETE
+139 18 ID
+139 18 LPAREN
+139 18 RETURN
+139 18 RBRACE
+139 18 STAR
+139 18 IF
+139 18 WHILE
+139 18 PRINTLN
+139 18 PUTCHAR
+139 18 DELETE
+)END";
+
+#endif
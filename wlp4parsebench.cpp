@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "wlp4tokens.h"
+
+// Benchmark for the wlp4parse driver. It generates token streams for a
+// chosen shape of program, as wlp4scan would have written them, runs
+// wlp4parse --stats on each and reports shifts/s and reductions/s over
+// the parser's own read-and-parse time, the peak RSS and the heap
+// allocations per input token. The tree is printed to /dev/null and its
+// printing is not part of the timing. The fastest of the runs counts.
+// Allocations are only counted by a parser built with -DWLP4PARSE_STATS;
+// otherwise they show as "-".
+//
+// Builds older than --stats, such as the original stack and unordered_map
+// parser, are timed with --wall instead: the parser runs without --stats
+// and the time is the whole process's wall clock, reading and printing
+// included, with the peak RSS from wait4. The shift and reduction counts
+// then come from the parse tree of an untimed first run, so --wall takes
+// no --ast or --flat. Those builds only read text streams, so add --text.
+//
+// Shapes:
+//   expr   wain with long + - chains and deeply parenthesized expressions
+//   stmts  wain with a long list of short statements, some if and while
+//   procs  many small procedures calling each other, then wain
+//   mixed  procedures with declarations and a mix of statements
+//
+// Arguments after -- are passed on to the driver, such as -j 4, --flat or
+// --ast. Streams are in the binary format unless --text is given.
+//
+// Usage: wlp4parsebench [--parser PATH] [--tokens N] [--depth D] [--reps N]
+//                       [--seed S] [--text] [--wall] [shape...] [-- driver args]
+// Build: g++ -std=c++20 -O2 wlp4parsebench.cpp -o wlp4parsebench
+
+struct StreamGenerator {
+    std::mt19937 rng;
+    int depth;
+    // Lexemes live here, so the views in tokens stay valid.
+    std::deque<std::string> spellings;
+    std::vector<std::pair<int, std::string_view>> tokens;
+    int num_procedures = 0;
+
+    StreamGenerator(unsigned seed, int depth) : rng(seed), depth(depth) {}
+
+    int pick(int n) {
+        return std::uniform_int_distribution<int>(0, n - 1)(rng);
+    }
+
+    void emit(std::string_view kind, std::string_view lexeme) {
+        tokens.emplace_back(tokenKindId(kind), lexeme);
+    }
+
+    std::string_view spelling(std::string text) {
+        return spellings.emplace_back(std::move(text));
+    }
+
+    void variable() {
+        static const std::string_view names[] = {"a", "b", "c", "d", "i", "n", "sum", "tmp"};
+        emit("ID", names[pick(std::size(names))]);
+    }
+
+    void number() {
+        static const std::string_view numbers[] = {"0", "1", "2", "7", "10", "42", "100", "65535"};
+        emit("NUM", numbers[pick(std::size(numbers))]);
+    }
+
+    // A call of one of the procedures generated so far, or getchar().
+    void call(int levels) {
+        if (num_procedures == 0) {
+            emit("GETCHAR", "getchar");
+            emit("LPAREN", "(");
+            emit("RPAREN", ")");
+            return;
+        }
+        emit("ID", spellings[pick(num_procedures)]);
+        emit("LPAREN", "(");
+        expr(levels);
+        emit("COMMA", ",");
+        expr(levels);
+        emit("RPAREN", ")");
+    }
+
+    // levels bounds the parenthesis nesting below this factor.
+    void factor(int levels) {
+        int choice = levels > 0 ? pick(8) : pick(3);
+        if (choice == 0) variable();
+        else if (choice == 1) number();
+        else if (choice == 2) {
+            emit("STAR", "*");
+            emit("AMP", "&");
+            variable();
+        }
+        else if (choice == 3) call(levels - 1);
+        else {
+            emit("LPAREN", "(");
+            expr(levels - 1);
+            emit("RPAREN", ")");
+        }
+    }
+
+    void term(int levels) {
+        static const std::pair<std::string_view, std::string_view> ops[] = {{"STAR", "*"}, {"SLASH", "/"}, {"PCT", "%"}};
+        factor(levels);
+        for (int n = pick(3); n > 0; --n) {
+            auto [kind, lexeme] = ops[pick(3)];
+            emit(kind, lexeme);
+            factor(levels);
+        }
+    }
+
+    void expr(int levels) {
+        term(levels);
+        for (int n = pick(3); n > 0; --n) {
+            if (pick(2)) emit("PLUS", "+");
+            else emit("MINUS", "-");
+            term(levels);
+        }
+    }
+
+    // A sum of depth terms, which the grammar nests depth expr deep.
+    void chain() {
+        for (int i = 0; i < depth; ++i) {
+            if (i > 0) emit(i % 2 ? "PLUS" : "MINUS", i % 2 ? "+" : "-");
+            if (pick(2)) variable();
+            else number();
+        }
+    }
+
+    // depth parentheses around a short expression.
+    void nested() {
+        for (int i = 0; i < depth; ++i) emit("LPAREN", "(");
+        expr(0);
+        for (int i = 0; i < depth; ++i) {
+            emit("RPAREN", ")");
+            if (pick(4) == 0) {
+                emit("PLUS", "+");
+                number();
+            }
+        }
+    }
+
+    void test() {
+        static const std::pair<std::string_view, std::string_view> ops[] = {
+            {"EQ", "=="}, {"NE", "!="}, {"LT", "<"}, {"LE", "<="}, {"GE", ">="}, {"GT", ">"},
+        };
+        expr(1);
+        auto [kind, lexeme] = ops[pick(std::size(ops))];
+        emit(kind, lexeme);
+        expr(1);
+    }
+
+    void assignment(int levels) {
+        variable();
+        emit("BECOMES", "=");
+        expr(levels);
+        emit("SEMI", ";");
+    }
+
+    // A statement; if and while get up to nesting levels of bodies.
+    void statement(int nesting) {
+        int choice = pick(10);
+        if (choice < 5 || nesting == 0) assignment(2);
+        else if (choice == 5) {
+            emit("PRINTLN", "println");
+            emit("LPAREN", "(");
+            expr(1);
+            emit("RPAREN", ")");
+            emit("SEMI", ";");
+        }
+        else if (choice < 8) {
+            emit("WHILE", "while");
+            emit("LPAREN", "(");
+            test();
+            emit("RPAREN", ")");
+            block(nesting - 1);
+        }
+        else {
+            emit("IF", "if");
+            emit("LPAREN", "(");
+            test();
+            emit("RPAREN", ")");
+            block(nesting - 1);
+            emit("ELSE", "else");
+            block(nesting - 1);
+        }
+    }
+
+    void block(int nesting) {
+        emit("LBRACE", "{");
+        for (int n = pick(4); n > 0; --n) statement(nesting);
+        emit("RBRACE", "}");
+    }
+
+    void declarations(int count) {
+        for (int i = 0; i < count; ++i) {
+            if (pick(4) == 0) {
+                emit("INT", "int");
+                emit("STAR", "*");
+                emit("ID", spelling("p" + std::to_string(i)));
+                emit("BECOMES", "=");
+                emit("NULL", "NULL");
+            }
+            else {
+                emit("INT", "int");
+                emit("ID", spelling("v" + std::to_string(i)));
+                emit("BECOMES", "=");
+                number();
+            }
+            emit("SEMI", ";");
+        }
+    }
+
+    void returnStatement() {
+        emit("RETURN", "return");
+        expr(1);
+        emit("SEMI", ";");
+        emit("RBRACE", "}");
+    }
+
+    void procedureHeader() {
+        spellings.push_front("f" + std::to_string(num_procedures++));
+        emit("INT", "int");
+        emit("ID", spellings.front());
+        emit("LPAREN", "(");
+        emit("INT", "int");
+        emit("ID", "a");
+        emit("COMMA", ",");
+        emit("INT", "int");
+        emit("ID", "b");
+        emit("RPAREN", ")");
+        emit("LBRACE", "{");
+    }
+
+    void wainHeader() {
+        static const std::pair<std::string_view, std::string_view> header[] = {
+            {"INT", "int"}, {"WAIN", "wain"}, {"LPAREN", "("}, {"INT", "int"}, {"ID", "a"},
+            {"COMMA", ","}, {"INT", "int"}, {"ID", "b"}, {"RPAREN", ")"}, {"LBRACE", "{"},
+        };
+        for (auto [kind, lexeme] : header) emit(kind, lexeme);
+    }
+
+    // Appends a whole program of the given shape with about size tokens.
+    void program(std::string_view shape, size_t size) {
+        if (shape == "procs" || shape == "mixed") {
+            while (tokens.size() < size) {
+                procedureHeader();
+                if (shape == "procs") {
+                    declarations(1);
+                    assignment(1);
+                    statement(1);
+                }
+                else {
+                    declarations(pick(6));
+                    for (int n = 20 + pick(40); n > 0; --n) statement(3);
+                }
+                returnStatement();
+            }
+            wainHeader();
+            declarations(2);
+            assignment(2);
+        }
+        else {
+            wainHeader();
+            declarations(4);
+            for (int i = 0; tokens.size() < size; ++i) {
+                if (shape == "stmts") {
+                    statement(2);
+                    continue;
+                }
+                variable();
+                emit("BECOMES", "=");
+                if (i % 2) nested();
+                else chain();
+                emit("SEMI", ";");
+            }
+        }
+        returnStatement();
+    }
+};
+
+bool writeStream(const std::string& path, const std::vector<std::pair<int, std::string_view>>& tokens, bool text) {
+    std::ofstream out(path, std::ios::binary);
+    if (text) {
+        for (auto [kind, lexeme] : tokens) out << TOKEN_KINDS[kind] << ' ' << lexeme << '\n';
+    }
+    else {
+        TokenStreamWriter writer;
+        for (auto [kind, lexeme] : tokens) {
+            if (!writer.add(kind, lexeme)) return false;
+        }
+        writer.write(out);
+    }
+    return bool(out);
+}
+
+// The line wlp4parse --stats writes at the end.
+struct ParseStats {
+    long terminals = 0;
+    size_t shifts = 0;
+    size_t reductions = 0;
+    double seconds = 0;
+    long peak_rss_kb = 0;
+    size_t allocations = 0;
+    bool counted_allocations = false;
+};
+
+// Runs args[0] with the given files as stdin, stdout and stderr and
+// waits for it. Fills in the wall clock and the peak RSS of the process;
+// false if it could not run or did not exit with 0.
+bool runProcess(const std::vector<std::string>& args, const std::string& in_path, const std::string& out_path,
+                const std::string& err_path, double& seconds, long& peak_rss_kb) {
+    std::vector<char*> argv;
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int in = open(in_path.c_str(), O_RDONLY);
+        int out = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int err = open(err_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (in < 0 || out < 0 || err < 0 || dup2(in, 0) < 0 || dup2(out, 1) < 0 || dup2(err, 2) < 0) _exit(127);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) return false;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    peak_rss_kb = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Reads the line wlp4parse --stats writes at the end.
+bool readStats(const std::string& stats_path, ParseStats& stats) {
+    std::ifstream in(stats_path);
+    for (std::string line; std::getline(in, line); ) {
+        int fields = std::sscanf(line.c_str(), "stats: terminals %ld shifts %zu reductions %zu parse_seconds %lf peak_rss_kb %ld allocations %zu",
+                                 &stats.terminals, &stats.shifts, &stats.reductions, &stats.seconds, &stats.peak_rss_kb, &stats.allocations);
+        if (fields >= 5) {
+            stats.counted_allocations = fields == 6;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Counts the parser steps behind a parse tree for --wall. Each line is a
+// node: leaves (terminal kinds are upper case) were shifted, every other
+// node is a reduction whose left-hand side was shifted in turn, except
+// the start symbol. BOF and EOF are not counted as terminals.
+bool countTree(const std::string& tree_path, ParseStats& stats) {
+    std::ifstream in(tree_path);
+    size_t leaves = 0;
+    size_t nodes = 0;
+    for (std::string line; std::getline(in, line); ++nodes) {
+        if (!line.empty() && line[0] >= 'A' && line[0] <= 'Z') ++leaves;
+    }
+    if (leaves < 2 || nodes == leaves) return false;
+    stats.terminals = leaves - 2;
+    stats.shifts = nodes - 1;
+    stats.reductions = nodes - leaves;
+    return true;
+}
+
+bool runBenchmark(std::string_view shape, const std::string& parser, const std::vector<std::string>& driver_args,
+                  size_t size, int depth, int reps, unsigned seed, bool text, bool wall) {
+    StreamGenerator gen(seed, depth);
+    gen.program(shape, size);
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string stream_path = (dir / ("wlp4parsebench-" + std::string(shape) + ".tok")).string();
+    std::string stats_path = (dir / ("wlp4parsebench-" + std::string(shape) + ".stats")).string();
+    std::string tree_path = (dir / ("wlp4parsebench-" + std::string(shape) + ".tree")).string();
+    if (!writeStream(stream_path, gen.tokens, text)) {
+        std::fprintf(stderr, "ERROR: cannot write %s\n", stream_path.c_str());
+        return false;
+    }
+    std::vector<std::string> args{parser};
+    if (!wall) args.push_back("--stats");
+    args.insert(args.end(), driver_args.begin(), driver_args.end());
+    ParseStats counts;
+    double seconds = 0;
+    long peak_rss_kb = 0;
+    bool ok = !wall || (runProcess(args, stream_path, tree_path, stats_path, seconds, peak_rss_kb) && countTree(tree_path, counts));
+    ParseStats best;
+    for (int i = 0; i < reps && ok; ++i) {
+        ParseStats stats = counts;
+        ok = runProcess(args, stream_path, "/dev/null", stats_path, seconds, peak_rss_kb);
+        if (wall) {
+            stats.seconds = seconds;
+            stats.peak_rss_kb = peak_rss_kb;
+        }
+        else ok = ok && readStats(stats_path, stats);
+        if (ok && (i == 0 || stats.seconds < best.seconds)) best = stats;
+    }
+    std::filesystem::remove(stream_path);
+    std::filesystem::remove(stats_path);
+    std::filesystem::remove(tree_path);
+    if (!ok) {
+        std::fprintf(stderr, "ERROR: %s failed on the %s stream%s\n", parser.c_str(), std::string(shape).c_str(),
+                     wall ? "" : " (a build without --stats needs --wall --text)");
+        return false;
+    }
+    char per_token[32] = "-";
+    if (best.counted_allocations) std::snprintf(per_token, sizeof(per_token), "%.4f", double(best.allocations) / gen.tokens.size());
+    std::printf("%-6s %9zu tok %10zu shift %10zu reduce %8.2f Mshift/s %8.2f Mreduce/s %8.1f MB rss %7s alloc/tok %7.3f s\n",
+                std::string(shape).c_str(), gen.tokens.size(), best.shifts, best.reductions,
+                best.shifts / best.seconds / 1e6, best.reductions / best.seconds / 1e6, best.peak_rss_kb / 1024.0,
+                per_token, best.seconds);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string parser = "./wlp4parse";
+    std::vector<std::string> driver_args;
+    size_t size = 2000000;
+    int depth = 200;
+    int reps = 3;
+    unsigned seed = 1;
+    bool text = false;
+    bool wall = false;
+    std::vector<std::string_view> shapes;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--parser" && i + 1 < argc) parser = argv[++i];
+        else if (arg == "--tokens" && i + 1 < argc) size = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--depth" && i + 1 < argc) depth = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = std::atoi(argv[++i]);
+        else if (arg == "--text") text = true;
+        else if (arg == "--wall") wall = true;
+        else if (arg == "expr" || arg == "stmts" || arg == "procs" || arg == "mixed") shapes.push_back(arg);
+        else if (arg == "--") {
+            while (++i < argc) driver_args.push_back(argv[i]);
+        }
+        else {
+            std::fprintf(stderr, "usage: wlp4parsebench [--parser PATH] [--tokens N] [--depth D] [--reps N] [--seed S] [--text] [--wall] [expr|stmts|procs|mixed...] [-- driver args]\n");
+            return 1;
+        }
+    }
+    for (const std::string& arg : driver_args) {
+        if (wall && (arg == "--ast" || arg == "--flat")) {
+            std::fprintf(stderr, "ERROR: --wall counts the steps from the parse tree, so it cannot take --ast or --flat\n");
+            return 1;
+        }
+    }
+    if (shapes.empty()) shapes = {"expr", "stmts", "procs", "mixed"};
+    bool ok = true;
+    for (std::string_view shape : shapes) ok = runBenchmark(shape, parser, driver_args, size, depth, reps, seed, text, wall) && ok;
+    return ok ? 0 : 1;
+}
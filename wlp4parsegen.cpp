@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lrtables.h"
+#include "wlp4data.h"
+
+// Writes wlp4parse_lalr.h, LALR(1) parse tables for a grammar in the .CFG
+// format of wlp4data.h: the LR(0) automaton is built from the grammar and
+// the lookaheads of every kernel item are propagated to a fixed point.
+// The tables are emitted in the .TRANSITIONS/.REDUCTIONS text format
+// together with the grammar they were built from, so lrtables.h turns
+// them into dense or comb-vector tables when wlp4parse is compiled with
+// -DWLP4PARSE_LALR. The first production is the start production and is
+// reduced on the .ACCEPT end marker, as in the checked-in tables.
+//
+// A report of the state count, entry counts and table density goes to
+// stderr. Grammars with conflicts are reported and no tables are written.
+//
+// Usage: wlp4parsegen [grammar] > wlp4parse_lalr.h
+// With no argument the grammar is WLP4_CFG.
+// Build: g++ -std=c++20 -O2 wlp4parsegen.cpp -o wlp4parsegen
+
+constexpr int MAX_SYMBOLS = 256;
+using SymbolSet = std::bitset<MAX_SYMBOLS>;
+
+struct Production {
+    int lhs;
+    std::vector<int> rhs;
+};
+
+struct Grammar {
+    std::vector<std::string> symbols;
+    std::map<std::string, int> symbol_ids;
+    std::vector<bool> nonterminal;
+    std::vector<Production> productions;
+    int end_symbol = -1;
+
+    int intern(const std::string& name) {
+        auto it = symbol_ids.find(name);
+        if (it != symbol_ids.end()) return it->second;
+        symbols.push_back(name);
+        nonterminal.push_back(false);
+        return symbol_ids[name] = int(symbols.size()) - 1;
+    }
+};
+
+// An LR(0) item: a production with a dot before rhs[dot].
+struct Item {
+    int production;
+    int dot;
+    bool operator<(const Item& other) const {
+        return production != other.production ? production < other.production : dot < other.dot;
+    }
+    bool operator==(const Item& other) const = default;
+};
+
+struct State {
+    std::vector<Item> kernel;
+    std::vector<SymbolSet> lookaheads;
+    std::vector<int> transitions;
+};
+
+bool readGrammar(std::string_view cfg, Grammar& grammar) {
+    bool ok = true;
+    forEachLrLine(cfg, [&](const auto& words, int count) {
+        Production production{grammar.intern(std::string(words[0])), {}};
+        for (int i = 1; i < count; ++i) {
+            if (words[i] != ".EMPTY") production.rhs.push_back(grammar.intern(std::string(words[i])));
+        }
+        grammar.productions.push_back(production);
+    });
+    grammar.end_symbol = grammar.intern(".ACCEPT");
+    for (const Production& production : grammar.productions) grammar.nonterminal[production.lhs] = true;
+    if (grammar.productions.empty()) {
+        std::cerr << "ERROR: the grammar has no productions" << std::endl;
+        ok = false;
+    }
+    if (grammar.symbols.size() > MAX_SYMBOLS) {
+        std::cerr << "ERROR: more than " << MAX_SYMBOLS << " grammar symbols" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// Nullable nonterminals and FIRST sets, by iterating to a fixed point.
+void computeFirstSets(const Grammar& grammar, std::vector<bool>& nullable, std::vector<SymbolSet>& first) {
+    int n = int(grammar.symbols.size());
+    nullable.assign(n, false);
+    first.assign(n, SymbolSet());
+    for (int s = 0; s < n; ++s) {
+        if (!grammar.nonterminal[s]) first[s].set(s);
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (const Production& production : grammar.productions) {
+            SymbolSet before = first[production.lhs];
+            bool all_nullable = true;
+            for (int symbol : production.rhs) {
+                first[production.lhs] |= first[symbol];
+                if (!nullable[symbol]) {
+                    all_nullable = false;
+                    break;
+                }
+            }
+            if (all_nullable && !nullable[production.lhs]) nullable[production.lhs] = changed = true;
+            if (first[production.lhs] != before) changed = true;
+        }
+    }
+}
+
+// Closes a set of items with their lookaheads: for every item A -> u . B v
+// with lookahead L, each B -> . w gets FIRST(v), plus L if v is nullable.
+std::map<Item, SymbolSet> closeItems(const Grammar& grammar, const std::vector<bool>& nullable,
+                                     const std::vector<SymbolSet>& first, const State& state) {
+    std::map<Item, SymbolSet> items;
+    std::vector<Item> work;
+    for (size_t i = 0; i < state.kernel.size(); ++i) {
+        items[state.kernel[i]] = state.lookaheads[i];
+        work.push_back(state.kernel[i]);
+    }
+    while (!work.empty()) {
+        Item item = work.back();
+        work.pop_back();
+        const std::vector<int>& rhs = grammar.productions[item.production].rhs;
+        if (item.dot == int(rhs.size()) || !grammar.nonterminal[rhs[item.dot]]) continue;
+        SymbolSet follow;
+        bool rest_nullable = true;
+        for (size_t i = item.dot + 1; i < rhs.size() && rest_nullable; ++i) {
+            follow |= first[rhs[i]];
+            rest_nullable = nullable[rhs[i]];
+        }
+        if (rest_nullable) follow |= items[item];
+        for (int p = 0; p < int(grammar.productions.size()); ++p) {
+            if (grammar.productions[p].lhs != rhs[item.dot]) continue;
+            auto [it, inserted] = items.try_emplace(Item{p, 0});
+            SymbolSet before = it->second;
+            it->second |= follow;
+            if (inserted || it->second != before) work.push_back(Item{p, 0});
+        }
+    }
+    return items;
+}
+
+// Builds the LR(0) automaton, numbering states in the order they are
+// reached from the start state, and then propagates LALR(1) lookaheads.
+std::vector<State> buildStates(const Grammar& grammar, const std::vector<bool>& nullable, const std::vector<SymbolSet>& first) {
+    int num_symbols = int(grammar.symbols.size());
+    std::vector<State> states(1);
+    states[0].kernel = {Item{0, 0}};
+    states[0].lookaheads = {SymbolSet().set(grammar.end_symbol)};
+    std::map<std::vector<Item>, int> state_ids{{states[0].kernel, 0}};
+    for (size_t s = 0; s < states.size(); ++s) {
+        std::map<Item, SymbolSet> items = closeItems(grammar, nullable, first, states[s]);
+        std::vector<std::vector<Item>> kernels(num_symbols);
+        for (const auto& [item, lookahead] : items) {
+            const std::vector<int>& rhs = grammar.productions[item.production].rhs;
+            if (item.dot < int(rhs.size())) kernels[rhs[item.dot]].push_back(Item{item.production, item.dot + 1});
+        }
+        states[s].transitions.assign(num_symbols, -1);
+        for (int symbol = 0; symbol < num_symbols; ++symbol) {
+            if (kernels[symbol].empty()) continue;
+            auto [it, inserted] = state_ids.try_emplace(kernels[symbol], int(states.size()));
+            if (inserted) {
+                states.push_back(State{kernels[symbol], std::vector<SymbolSet>(kernels[symbol].size()), {}});
+            }
+            states[s].transitions[symbol] = it->second;
+        }
+    }
+
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (State& state : states) {
+            for (const auto& [item, lookahead] : closeItems(grammar, nullable, first, state)) {
+                const std::vector<int>& rhs = grammar.productions[item.production].rhs;
+                if (item.dot == int(rhs.size())) continue;
+                State& target = states[state.transitions[rhs[item.dot]]];
+                size_t k = std::lower_bound(target.kernel.begin(), target.kernel.end(), Item{item.production, item.dot + 1}) - target.kernel.begin();
+                SymbolSet before = target.lookaheads[k];
+                target.lookaheads[k] |= lookahead;
+                if (target.lookaheads[k] != before) changed = true;
+            }
+        }
+    }
+    return states;
+}
+
+int main(int argc, char* argv[]) {
+    std::string cfg(WLP4_CFG);
+    bool default_grammar = argc < 2;
+    if (!default_grammar) {
+        std::ifstream file(argv[1]);
+        if (!file) {
+            std::cerr << "ERROR: cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+        cfg.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    Grammar grammar;
+    if (!readGrammar(cfg, grammar)) return 1;
+    std::vector<bool> nullable;
+    std::vector<SymbolSet> first;
+    computeFirstSets(grammar, nullable, first);
+    std::vector<State> states = buildStates(grammar, nullable, first);
+
+    int num_symbols = int(grammar.symbols.size());
+    std::string transitions = ".TRANSITIONS\n";
+    std::string reductions = ".REDUCTIONS\n";
+    int shifts = 0, gotos = 0, reduces = 0, conflicts = 0;
+    for (int s = 0; s < int(states.size()); ++s) {
+        for (int symbol = 0; symbol < num_symbols; ++symbol) {
+            int t = states[s].transitions[symbol];
+            if (t < 0) continue;
+            ++(grammar.nonterminal[symbol] ? gotos : shifts);
+            transitions += std::to_string(s) + " " + grammar.symbols[symbol] + " " + std::to_string(t) + "\n";
+        }
+        std::vector<int> reduce_on(num_symbols, -1);
+        for (const auto& [item, lookahead] : closeItems(grammar, nullable, first, states[s])) {
+            if (item.dot < int(grammar.productions[item.production].rhs.size())) continue;
+            for (int symbol = 0; symbol < num_symbols; ++symbol) {
+                if (!lookahead[symbol]) continue;
+                if (states[s].transitions[symbol] >= 0 || reduce_on[symbol] >= 0) {
+                    std::cerr << "conflict in state " << s << " on " << grammar.symbols[symbol] << ": "
+                              << (reduce_on[symbol] >= 0 ? "reduce/reduce" : "shift/reduce") << std::endl;
+                    ++conflicts;
+                    continue;
+                }
+                reduce_on[symbol] = item.production;
+                ++reduces;
+                reductions += std::to_string(s) + " " + std::to_string(item.production) + " " + grammar.symbols[symbol] + "\n";
+            }
+        }
+    }
+
+    int num_nonterminals = int(std::count(grammar.nonterminal.begin(), grammar.nonterminal.end(), true));
+    long long cells = (long long) states.size() * num_symbols;
+    std::fprintf(stderr, "grammar: %zu productions, %d terminals, %d nonterminals\n",
+                 grammar.productions.size(), num_symbols - num_nonterminals, num_nonterminals);
+    std::fprintf(stderr, "LALR(1) states: %zu\n", states.size());
+    std::fprintf(stderr, "entries: %d shift, %d goto, %d reduce; %.1f%% of %lld cells\n",
+                 shifts, gotos, reduces, 100.0 * (shifts + gotos + reduces) / cells, cells);
+    if (default_grammar) {
+        LrTableSizes checked_in = measureLrTables(WLP4_CFG, WLP4_TRANSITIONS, WLP4_REDUCTIONS);
+        int lines[2] = {};
+        forEachLrLine(WLP4_TRANSITIONS, [&](const auto&, int) { ++lines[0]; });
+        forEachLrLine(WLP4_REDUCTIONS, [&](const auto&, int) { ++lines[1]; });
+        std::fprintf(stderr, "checked-in tables: %d states, %d transitions, %d reductions\n",
+                     checked_in.states, lines[0], lines[1]);
+    }
+    if (conflicts) {
+        std::fprintf(stderr, "conflicts: %d; no tables written\n", conflicts);
+        return 1;
+    }
+
+    if (cfg.back() != '\n') cfg += '\n';
+    std::printf("// Generated by wlp4parsegen. Do not edit.\n");
+    std::printf("#ifndef WLP4PARSE_LALR_H\n#define WLP4PARSE_LALR_H\n#include <string_view>\n\n");
+    std::printf("constexpr std::string_view LALR_CFG = R\"END(%s)END\";\n\n", cfg.c_str());
+    std::printf("constexpr std::string_view LALR_TRANSITIONS = R\"END(%s)END\";\n\n", transitions.c_str());
+    std::printf("constexpr std::string_view LALR_REDUCTIONS = R\"END(%s)END\";\n\n", reductions.c_str());
+    std::printf("#endif\n");
+}
@@ -0,0 +1,442 @@
+#ifndef WLP4SCAN_H
+#define WLP4SCAN_H
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "dfatable.h"
+#include "wlp4tokens.h"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// The WLP4 scanner core shared by wlp4scan and the tools built on it.
+// scanText() reports tokens through callbacks and owns no buffers.
+
+constexpr char wlp4_dfa[] = {
+  0x2e, 0x41, 0x4c, 0x50, 0x48, 0x41, 0x42, 0x45, 0x54, 0x0a, 0x61, 0x2d,
+  0x7a, 0x20, 0x41, 0x2d, 0x5a, 0x20, 0x28, 0x20, 0x29, 0x20, 0x30, 0x2d,
+  0x39, 0x20, 0x7b, 0x20, 0x7d, 0x20, 0x3d, 0x20, 0x21, 0x20, 0x3c, 0x20,
+  0x3e, 0x20, 0x2b, 0x20, 0x2d, 0x20, 0x2a, 0x20, 0x2f, 0x20, 0x25, 0x20,
+  0x2c, 0x20, 0x3b, 0x20, 0x5b, 0x20, 0x5d, 0x20, 0x26, 0x20, 0x2e, 0x53,
+  0x50, 0x41, 0x43, 0x45, 0x20, 0x2e, 0x4e, 0x45, 0x57, 0x4c, 0x49, 0x4e,
+  0x45, 0x0a, 0x2e, 0x53, 0x54, 0x41, 0x54, 0x45, 0x53, 0x0a, 0x73, 0x74,
+  0x61, 0x72, 0x74, 0x0a, 0x73, 0x6c, 0x61, 0x73, 0x68, 0x21, 0x0a, 0x73,
+  0x70, 0x61, 0x63, 0x65, 0x21, 0x0a, 0x6e, 0x65, 0x77, 0x6c, 0x69, 0x6e,
+  0x65, 0x21, 0x0a, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x6c, 0x61,
+  0x73, 0x68, 0x21, 0x0a, 0x63, 0x6f, 0x6d, 0x6d, 0x65, 0x6e, 0x74, 0x64,
+  0x6f, 0x6e, 0x65, 0x21, 0x0a, 0x69, 0x64, 0x21, 0x0a, 0x6c, 0x70, 0x61,
+  0x72, 0x65, 0x6e, 0x21, 0x20, 0x72, 0x70, 0x61, 0x72, 0x65, 0x6e, 0x21,
+  0x0a, 0x6c, 0x62, 0x72, 0x61, 0x63, 0x65, 0x21, 0x20, 0x72, 0x62, 0x72,
+  0x61, 0x63, 0x65, 0x21, 0x0a, 0x6c, 0x62, 0x72, 0x61, 0x63, 0x6b, 0x21,
+  0x20, 0x72, 0x62, 0x72, 0x61, 0x63, 0x6b, 0x21, 0x0a, 0x62, 0x65, 0x63,
+  0x6f, 0x6d, 0x65, 0x73, 0x21, 0x20, 0x65, 0x71, 0x21, 0x20, 0x65, 0x78,
+  0x63, 0x6c, 0x61, 0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x6e, 0x65,
+  0x71, 0x21, 0x0a, 0x67, 0x74, 0x21, 0x20, 0x6c, 0x74, 0x21, 0x20, 0x67,
+  0x65, 0x71, 0x21, 0x20, 0x6c, 0x65, 0x21, 0x0a, 0x70, 0x6c, 0x75, 0x73,
+  0x21, 0x20, 0x6d, 0x69, 0x6e, 0x75, 0x73, 0x21, 0x20, 0x73, 0x74, 0x61,
+  0x72, 0x21, 0x20, 0x70, 0x63, 0x74, 0x21, 0x20, 0x63, 0x6f, 0x6d, 0x6d,
+  0x61, 0x21, 0x20, 0x73, 0x65, 0x6d, 0x69, 0x21, 0x20, 0x61, 0x6d, 0x70,
+  0x21, 0x0a, 0x66, 0x69, 0x72, 0x73, 0x74, 0x5f, 0x7a, 0x65, 0x72, 0x6f,
+  0x21, 0x20, 0x6e, 0x75, 0x6d, 0x21, 0x0a, 0x2e, 0x54, 0x52, 0x41, 0x4e,
+  0x53, 0x49, 0x54, 0x49, 0x4f, 0x4e, 0x53, 0x0a, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x20, 0x2f, 0x20, 0x73, 0x6c, 0x61, 0x73, 0x68, 0x0a, 0x73, 0x74,
+  0x61, 0x72, 0x74, 0x20, 0x2e, 0x53, 0x50, 0x41, 0x43, 0x45, 0x20, 0x73,
+  0x70, 0x61, 0x63, 0x65, 0x0a, 0x73, 0x70, 0x61, 0x63, 0x65, 0x20, 0x2e,
+  0x53, 0x50, 0x41, 0x43, 0x45, 0x20, 0x73, 0x70, 0x61, 0x63, 0x65, 0x0a,
+  0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x2e, 0x4e, 0x45, 0x57, 0x4c, 0x49,
+  0x4e, 0x45, 0x20, 0x6e, 0x65, 0x77, 0x6c, 0x69, 0x6e, 0x65, 0x0a, 0x6e,
+  0x65, 0x77, 0x6c, 0x69, 0x6e, 0x65, 0x20, 0x2e, 0x4e, 0x45, 0x57, 0x4c,
+  0x49, 0x4e, 0x45, 0x20, 0x6e, 0x65, 0x77, 0x6c, 0x69, 0x6e, 0x65, 0x0a,
+  0x73, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x2f, 0x20, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x73, 0x6c, 0x61, 0x73, 0x68, 0x0a, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x73, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x2e, 0x4e, 0x45, 0x57,
+  0x4c, 0x49, 0x4e, 0x45, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x65, 0x6e, 0x74,
+  0x64, 0x6f, 0x6e, 0x65, 0x0a, 0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73,
+  0x6c, 0x61, 0x73, 0x68, 0x20, 0x2e, 0x4f, 0x54, 0x48, 0x45, 0x52, 0x20,
+  0x73, 0x65, 0x63, 0x6f, 0x6e, 0x64, 0x73, 0x6c, 0x61, 0x73, 0x68, 0x0a,
+  0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x28, 0x20, 0x6c, 0x70, 0x61, 0x72,
+  0x65, 0x6e, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x29, 0x20, 0x72,
+  0x70, 0x61, 0x72, 0x65, 0x6e, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20,
+  0x7b, 0x20, 0x6c, 0x62, 0x72, 0x61, 0x63, 0x65, 0x0a, 0x73, 0x74, 0x61,
+  0x72, 0x74, 0x20, 0x7d, 0x20, 0x72, 0x62, 0x72, 0x61, 0x63, 0x65, 0x0a,
+  0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x5b, 0x20, 0x6c, 0x62, 0x72, 0x61,
+  0x63, 0x6b, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x5d, 0x20, 0x72,
+  0x62, 0x72, 0x61, 0x63, 0x6b, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20,
+  0x3d, 0x20, 0x62, 0x65, 0x63, 0x6f, 0x6d, 0x65, 0x73, 0x0a, 0x62, 0x65,
+  0x63, 0x6f, 0x6d, 0x65, 0x73, 0x20, 0x3d, 0x20, 0x65, 0x71, 0x0a, 0x73,
+  0x74, 0x61, 0x72, 0x74, 0x20, 0x21, 0x20, 0x65, 0x78, 0x63, 0x6c, 0x61,
+  0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x0a, 0x65, 0x78, 0x63, 0x6c, 0x61,
+  0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x3d, 0x20, 0x6e, 0x65, 0x71,
+  0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x3e, 0x20, 0x67, 0x74, 0x0a,
+  0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x3c, 0x20, 0x6c, 0x74, 0x0a, 0x67,
+  0x74, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x71, 0x0a, 0x6c, 0x74, 0x20, 0x3d,
+  0x20, 0x6c, 0x65, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x2b, 0x20,
+  0x70, 0x6c, 0x75, 0x73, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20, 0x2d,
+  0x20, 0x6d, 0x69, 0x6e, 0x75, 0x73, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74,
+  0x20, 0x2a, 0x20, 0x73, 0x74, 0x61, 0x72, 0x0a, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x20, 0x25, 0x20, 0x70, 0x63, 0x74, 0x0a, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x20, 0x2c, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x0a, 0x73, 0x74,
+  0x61, 0x72, 0x74, 0x20, 0x3b, 0x20, 0x73, 0x65, 0x6d, 0x69, 0x0a, 0x73,
+  0x74, 0x61, 0x72, 0x74, 0x20, 0x26, 0x20, 0x61, 0x6d, 0x70, 0x0a, 0x73,
+  0x74, 0x61, 0x72, 0x74, 0x20, 0x30, 0x20, 0x66, 0x69, 0x72, 0x73, 0x74,
+  0x5f, 0x7a, 0x65, 0x72, 0x6f, 0x0a, 0x73, 0x74, 0x61, 0x72, 0x74, 0x20,
+  0x31, 0x2d, 0x39, 0x20, 0x6e, 0x75, 0x6d, 0x0a, 0x6e, 0x75, 0x6d, 0x20,
+  0x30, 0x2d, 0x39, 0x20, 0x6e, 0x75, 0x6d, 0x0a, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x20, 0x61, 0x2d, 0x7a, 0x20, 0x41, 0x2d, 0x5a, 0x20, 0x69, 0x64,
+  0x0a, 0x69, 0x64, 0x20, 0x61, 0x2d, 0x7a, 0x20, 0x41, 0x2d, 0x5a, 0x20,
+  0x30, 0x2d, 0x39, 0x20, 0x69, 0x64
+};
+constexpr unsigned int wlp4_dfa_len = 858;
+
+constexpr std::pair<std::string_view, std::string_view> names[] = {
+  {"slash", "SLASH"},
+  {"id", "ID"},
+
+  {"lparen", "LPAREN"},
+  {"rparen", "RPAREN"},
+  {"lbrace", "LBRACE"},
+  {"rbrace", "RBRACE"},
+  {"lbrack", "LBRACK"},
+  {"rbrack", "RBRACK"},
+  {"becomes", "BECOMES"},
+  {"eq", "EQ"},
+  {"neq", "NE"},
+  {"gt", "GT"},
+  {"lt", "LT"},
+  {"geq", "GE"},
+  {"le", "LE"},
+  {"plus", "PLUS"},
+  {"minus", "MINUS"},
+  {"star", "STAR"},
+  {"pct", "PCT"},
+  {"comma", "COMMA"},
+  {"semi", "SEMI"},
+  {"amp", "AMP"},
+
+  {"first_zero", "NUM"},
+  {"num", "NUM"},
+};
+
+constexpr std::string_view WLP4_DFA_TEXT{wlp4_dfa, wlp4_dfa_len};
+constexpr int NUM_DFA_STATES = countDfaStates(WLP4_DFA_TEXT);
+
+constexpr int stateKind(std::string_view name) {
+  for (const auto& entry : names) {
+    if (entry.first == name) return tokenKindId(entry.second);
+  }
+  return -1;
+}
+
+constexpr bool isCommentState(std::string_view name) {
+  return name == "secondslash" || name == "commentdone";
+}
+
+// States that the scanner treats alike get the same label, and only
+// those may be merged by minimization.
+constexpr int stateLabel(std::string_view name) {
+  if (isCommentState(name)) return -2;
+  if (name == "id") return -3;
+  if (name == "num") return -4;
+  return stateKind(name);
+}
+
+// The DFA is compiled into numbered states when the scanner itself is
+// compiled, then minimized. dfa.transitions is a flat [state][256] array
+// indexed by state * 256 + byte, and the arrays below are parallel arrays
+// indexed by state number, so there is no table construction at startup.
+constexpr DfaTables<NUM_DFA_STATES> full_dfa = buildDfa<NUM_DFA_STATES>(WLP4_DFA_TEXT);
+constexpr std::array<int, NUM_DFA_STATES> state_labels = [] {
+  std::array<int, NUM_DFA_STATES> result{};
+  for (int i = 0; i < NUM_DFA_STATES; ++i) result[i] = stateLabel(full_dfa.state_names[i]);
+  return result;
+}();
+constexpr std::array<int, NUM_DFA_STATES> state_numbers = minimizedStates(full_dfa, state_labels);
+constexpr int NUM_STATES = countMinimizedStates(state_numbers);
+constexpr DfaTables<NUM_STATES> dfa = minimizeDfa<NUM_STATES>(full_dfa, state_numbers);
+
+template <typename T, typename F>
+constexpr std::array<T, NUM_STATES> perState(F f) {
+  std::array<T, NUM_STATES> result{};
+  for (int i = 0; i < NUM_STATES; ++i) result[i] = f(dfa.state_names[i]);
+  return result;
+}
+
+constexpr std::array<int, NUM_STATES> token_kind = perState<int>(stateKind);
+constexpr std::array<bool, NUM_STATES> is_comment = perState<bool>(isCommentState);
+constexpr std::array<bool, NUM_STATES> needs_range_check = perState<bool>([](std::string_view name) {
+  return name == "num";
+});
+constexpr int ID_STATE = dfa.stateId("id");
+static_assert([] {
+  for (int i = 0; i < NUM_STATES; ++i) {
+    if (dfa.next(i, ' ') != DEAD_STATE || dfa.next(i, '\n') != DEAD_STATE) return false;
+  }
+  return true;
+}(), "scanText assumes tokens never contain spaces or newlines");
+
+// Keywords are scanned as identifiers and then classified with a perfect
+// hash over their first character, last character and length. The seed
+// is searched for at compile time.
+constexpr std::pair<std::string_view, std::string_view> keywords[] = {
+  {"wain", "WAIN"},
+  {"int", "INT"},
+  {"if", "IF"},
+  {"else", "ELSE"},
+  {"while", "WHILE"},
+  {"println", "PRINTLN"},
+  {"putchar", "PUTCHAR"},
+  {"getchar", "GETCHAR"},
+  {"return", "RETURN"},
+  {"NULL", "NULL"},
+  {"new", "NEW"},
+  {"delete", "DELETE"},
+};
+constexpr unsigned KEYWORD_SLOTS = 32;
+
+constexpr unsigned keywordHash(std::string_view s, unsigned seed) {
+  return ((unsigned char) s.front() * seed + (unsigned char) s.back() + s.length()) % KEYWORD_SLOTS;
+}
+
+constexpr unsigned KEYWORD_SEED = [] {
+  for (unsigned seed = 1; seed < 1000; ++seed) {
+    std::array<bool, KEYWORD_SLOTS> used{};
+    bool collision = false;
+    for (const auto& keyword : keywords) {
+      unsigned slot = keywordHash(keyword.first, seed);
+      collision = collision || used[slot];
+      used[slot] = true;
+    }
+    if (!collision) return seed;
+  }
+  return 0u;
+}();
+static_assert(KEYWORD_SEED != 0, "no perfect hash seed for the keyword set");
+
+constexpr std::array<std::pair<std::string_view, int>, KEYWORD_SLOTS> keyword_table = [] {
+  std::array<std::pair<std::string_view, int>, KEYWORD_SLOTS> table{};
+  for (const auto& keyword : keywords) {
+    table[keywordHash(keyword.first, KEYWORD_SEED)] = {keyword.first, tokenKindId(keyword.second)};
+  }
+  return table;
+}();
+
+inline int identifierKind(std::string_view lexeme) {
+  const auto& slot = keyword_table[keywordHash(lexeme, KEYWORD_SEED)];
+  return slot.first == lexeme ? slot.second : token_kind[ID_STATE];
+}
+
+// NUM lexemes never have leading zeros, so comparing digit strings is
+// equivalent to converting them and comparing against INT_MAX.
+inline bool outOfRange(std::string_view digits) {
+  return digits.length() > 10 || (digits.length() == 10 && digits > "2147483647");
+}
+
+// Error callbacks take the message and, if they accept one, the lexeme
+// that failed.
+template <typename Error>
+void reportError(Error& error, const char* message, std::string_view lexeme) {
+  if constexpr (std::is_invocable_v<Error&, const char*, std::string_view>) error(message, lexeme);
+  else error(message);
+}
+
+// Reports the token that ended in state, or the matching error.
+template <typename Emit, typename Error>
+void finishToken(int state, std::string_view lexeme, Emit& emit, Error& error) {
+  if (needs_range_check[state] && outOfRange(lexeme)) reportError(error, "ERROR RANGE", lexeme);
+  else if (state == ID_STATE) emit(identifierKind(lexeme), lexeme);
+  else if (dfa.accepting[state]) emit(token_kind[state], lexeme);
+  else reportError(error, "ERROR", lexeme);
+}
+
+// Returns the first position in [p, end) whose byte differs from (or,
+// with Match, equals) target. Whitespace runs and comment tails are
+// crossed 32 or 16 bytes at a time when AVX2 or SSE2 is available.
+template <bool Match>
+const char* scanBytes(const char* p, const char* end, char target) {
+#if defined(__AVX2__)
+  const __m256i wide = _mm256_set1_epi8(target);
+  while (end - p >= 32) {
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) p), wide));
+    if (!Match) mask = ~mask;
+    if (mask) return p + __builtin_ctz(mask);
+    p += 32;
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i narrow = _mm_set1_epi8(target);
+  while (end - p >= 16) {
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) p), narrow));
+    if (!Match) mask = ~mask & 0xffff;
+    if (mask) return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+  while (p < end && (*p == target) != Match) ++p;
+  return p;
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+  // Most runs are a single separating space; avoid the vector setup.
+  if (p + 1 < end && p[1] != ' ') return p + 1;
+  return scanBytes<false>(p, end, ' ');
+}
+
+inline const char* findNewline(const char* p, const char* end) {
+  return scanBytes<true>(p, end, '\n');
+}
+
+#if defined(WLP4SCAN_DIRECT)
+// Direct-coded matcher generated by wlp4scangen.
+#include "wlp4scan_direct.h"
+static_assert(DIRECT_DFA_FINGERPRINT == dfaFingerprint(dfa), "wlp4scan_direct.h is stale; rerun wlp4scangen");
+#endif
+
+// The longest match at p, from the table-driven engine or, when built
+// with -DWLP4SCAN_DIRECT, from the generated direct-coded one.
+inline DfaMatch matchToken(const char* p, const char* end) {
+#if defined(WLP4SCAN_DIRECT)
+  return directLongestMatch(p, end);
+#else
+  return dfa.longestMatch(p, end);
+#endif
+}
+
+// Scans a whole buffer in one pass. Each line is scanned independently,
+// exactly as if the input had been read with std::getline. Every lexeme
+// is a contiguous slice of its line, so tokens are reported as
+// string_views into the input and no per-token allocation happens.
+template <typename Emit, typename Error>
+void scanText(std::string_view text, Emit emit, Error error) {
+  const char* p = text.data();
+  const char* end = p + text.size();
+  while (p < end) {
+    char c = *p;
+    if (c == '\n') {
+      ++p;
+      continue;
+    }
+    if (c == ' ') {
+      p = skipSpaces(p, end);
+      continue;
+    }
+    // No state has a transition on a space or a newline, so a match never
+    // leaves its line.
+    DfaMatch match = matchToken(p, end);
+    // Comment states have no outgoing transitions, so the rest of the
+    // line belongs to the comment.
+    if (is_comment[match.state]) {
+      p = findNewline(match.end, end);
+      continue;
+    }
+    finishToken(match.state, std::string_view(p, match.end - p), emit, error);
+    // The offending character starts the next lexeme, unless nothing was
+    // matched before it. A space there is skipped by the next iteration.
+    p = match.end == p ? p + 1 : match.end;
+  }
+}
+
+// Token kinds used by IncrementalScanner for scan errors.
+const int SCAN_ERROR = -1;
+const int SCAN_RANGE_ERROR = -2;
+
+struct ScannedToken {
+  int kind;
+  uint32_t column;
+  uint32_t length;
+};
+
+// Keeps the tokens of a buffer that is being edited and rescans only what
+// an edit touches. Lines are scanned independently and every line starts
+// in the start state, so the new token stream always lines up with the
+// old one again at the first line the edit did not touch; nothing after
+// it is rescanned. Each line owns its text and tokens, with positions
+// relative to the line, so an edit that keeps the line count costs time
+// proportional to the lines it touches, not to the file.
+struct IncrementalScanner {
+  struct Line {
+    std::string text;
+    std::vector<ScannedToken> tokens;
+  };
+
+  std::vector<Line> lines;
+
+  static void scanLine(Line& line) {
+    line.tokens.clear();
+    const char* base = line.text.data();
+    auto add = [&](int kind, std::string_view lexeme) {
+      line.tokens.push_back(ScannedToken{kind, uint32_t(lexeme.data() - base), uint32_t(lexeme.size())});
+    };
+    scanText(line.text, add, [&](const char* message, std::string_view lexeme) {
+      add(std::string_view(message) == "ERROR RANGE" ? SCAN_RANGE_ERROR : SCAN_ERROR, lexeme);
+    });
+  }
+
+  // Splits text into lines (the text after the last newline is always a
+  // line, possibly empty) and scans them.
+  static std::vector<Line> scanLines(std::string_view text) {
+    std::vector<Line> result;
+    while (true) {
+      size_t newline = text.find('\n');
+      result.push_back(Line{std::string(text.substr(0, newline)), {}});
+      scanLine(result.back());
+      if (newline == std::string_view::npos) break;
+      text.remove_prefix(newline + 1);
+    }
+    return result;
+  }
+
+  void load(std::string_view text) {
+    lines = scanLines(text);
+  }
+
+  // Replaces removed bytes starting at byte column of line (a removed
+  // range may run across newlines) with inserted, which may contain
+  // newlines. Positions are line/column because absolute offsets would
+  // shift for every later line on each edit. Returns the number of lines
+  // that were rescanned, starting at line, or 0 without changing anything
+  // if the position or the removed range is outside the buffer.
+  size_t edit(size_t line, size_t column, size_t removed, std::string_view inserted) {
+    if (lines.empty()) load("");
+    if (line >= lines.size() || column > lines[line].text.size()) return 0;
+    size_t available = lines[line].text.size() - column;
+    for (size_t next = line + 1; available < removed && next < lines.size(); ++next) {
+      available += 1 + lines[next].text.size();
+    }
+    if (available < removed) return 0;
+    size_t last = line;
+    std::string joined = std::move(lines[line].text);
+    while (column + removed > joined.size()) {
+      joined += '\n';
+      joined += lines[++last].text;
+    }
+    joined.replace(column, removed, inserted);
+    std::vector<Line> replacement = scanLines(joined);
+    size_t old_count = last - line + 1;
+    size_t common = std::min(old_count, replacement.size());
+    for (size_t i = 0; i < common; ++i) lines[line + i] = std::move(replacement[i]);
+    if (replacement.size() < old_count) {
+      lines.erase(lines.begin() + (line + common), lines.begin() + (last + 1));
+    } else {
+      lines.insert(lines.begin() + (last + 1), std::make_move_iterator(replacement.begin() + common),
+                   std::make_move_iterator(replacement.end()));
+    }
+    return replacement.size();
+  }
+
+  // Calls emit(kind, lexeme) for every token in order, with the scan
+  // errors interleaved as SCAN_ERROR and SCAN_RANGE_ERROR tokens.
+  template <typename Emit>
+  void forEachToken(Emit emit) const {
+    for (const Line& l : lines) {
+      for (const ScannedToken& t : l.tokens) emit(t.kind, std::string_view(l.text).substr(t.column, t.length));
+    }
+  }
+};
+
+#endif
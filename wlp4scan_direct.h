@@ -0,0 +1,218 @@
+// Generated by wlp4scangen from the DFA in wlp4scan.h. Do not edit.
+#ifndef WLP4SCAN_DIRECT_H
+#define WLP4SCAN_DIRECT_H
+
+constexpr unsigned long long DIRECT_DFA_FINGERPRINT = 12837305016768772070ull;
+
+constexpr bool direct_loop12[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+constexpr bool direct_loop17[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+  0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+  0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+// Same contract as DfaTables::longestMatch on the scanner DFA.
+inline DfaMatch directLongestMatch(const char* p, const char* end) {
+  // start
+  if (p == end) return {p, 0};
+  switch ((unsigned char) *p) {
+  case '!':
+    ++p;
+    goto state1;
+  case '%':
+    ++p;
+    goto state2;
+  case '&':
+    ++p;
+    goto state3;
+  case '(':
+    ++p;
+    goto state4;
+  case ')':
+    ++p;
+    goto state5;
+  case '*':
+    ++p;
+    goto state6;
+  case '+':
+    ++p;
+    goto state7;
+  case ',':
+    ++p;
+    goto state8;
+  case '-':
+    ++p;
+    goto state9;
+  case '/':
+    ++p;
+    goto state10;
+  case '0':
+    ++p;
+    goto state11;
+  case '1' ... '9':
+    ++p;
+    goto state12;
+  case ';':
+    ++p;
+    goto state13;
+  case '<':
+    ++p;
+    goto state14;
+  case '=':
+    ++p;
+    goto state15;
+  case '>':
+    ++p;
+    goto state16;
+  case 'A' ... 'Z':
+  case 'a' ... 'z':
+    ++p;
+    goto state17;
+  case '[':
+    ++p;
+    goto state18;
+  case ']':
+    ++p;
+    goto state19;
+  case '{':
+    ++p;
+    goto state20;
+  case '}':
+    ++p;
+    goto state21;
+  default:
+    return {p, 0};
+  }
+state1:
+  // exclamation
+  if (p == end) return {p, 1};
+  switch ((unsigned char) *p) {
+  case '=':
+    ++p;
+    goto state22;
+  default:
+    return {p, 1};
+  }
+state2:
+  // pct
+  return {p, 2};
+state3:
+  // amp
+  return {p, 3};
+state4:
+  // lparen
+  return {p, 4};
+state5:
+  // rparen
+  return {p, 5};
+state6:
+  // star
+  return {p, 6};
+state7:
+  // plus
+  return {p, 7};
+state8:
+  // comma
+  return {p, 8};
+state9:
+  // minus
+  return {p, 9};
+state10:
+  // slash
+  if (p == end) return {p, 10};
+  switch ((unsigned char) *p) {
+  case '/':
+    ++p;
+    goto state23;
+  default:
+    return {p, 10};
+  }
+state11:
+  // first_zero
+  return {p, 11};
+state12:
+  // num
+  while (p != end && direct_loop12[(unsigned char) *p]) ++p;
+  return {p, 12};
+state13:
+  // semi
+  return {p, 13};
+state14:
+  // lt
+  if (p == end) return {p, 14};
+  switch ((unsigned char) *p) {
+  case '=':
+    ++p;
+    goto state24;
+  default:
+    return {p, 14};
+  }
+state15:
+  // becomes
+  if (p == end) return {p, 15};
+  switch ((unsigned char) *p) {
+  case '=':
+    ++p;
+    goto state25;
+  default:
+    return {p, 15};
+  }
+state16:
+  // gt
+  if (p == end) return {p, 16};
+  switch ((unsigned char) *p) {
+  case '=':
+    ++p;
+    goto state26;
+  default:
+    return {p, 16};
+  }
+state17:
+  // id
+  while (p != end && direct_loop17[(unsigned char) *p]) ++p;
+  return {p, 17};
+state18:
+  // lbrack
+  return {p, 18};
+state19:
+  // rbrack
+  return {p, 19};
+state20:
+  // lbrace
+  return {p, 20};
+state21:
+  // rbrace
+  return {p, 21};
+state22:
+  // neq
+  return {p, 22};
+state23:
+  // secondslash
+  return {p, 23};
+state24:
+  // le
+  return {p, 24};
+state25:
+  // eq
+  return {p, 25};
+state26:
+  // geq
+  return {p, 26};
+}
+
+#endif
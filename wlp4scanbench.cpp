@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "wlp4scan.h"
+
+// Throughput benchmark for the scanner in wlp4scan.h. It generates WLP4
+// source with a chosen token mix, runs scanText over it in-process and
+// reports tokens/s, MB/s and heap allocations per token.
+//
+// With --edits N each source is also loaded into an IncrementalScanner and
+// N random edits are applied to it, some of them across lines and some at
+// positions outside the buffer, which have to be rejected. The time per
+// edit is reported, and the tokens afterwards have to match a full
+// scanText of the edited text; the exit status is 1 if they do not.
+//
+// Usage: wlp4scanbench [--size MB] [--reps N] [--seed S] [--edits N] [mix...]
+// Mixes: id, num, comment, op, mixed (default: all of them).
+// Build: g++ -std=c++20 -O2 wlp4scanbench.cpp -o wlp4scanbench
+
+// Counts every heap allocation for alloc/tok. The array and nothrow forms
+// the library provides go through the plain and aligned ones.
+std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  ++allocations;
+  size_t align = size_t(alignment);
+  if (void* p = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+const std::string_view GEN_KEYWORDS[] = {
+  "int", "wain", "if", "else", "while", "println", "return", "NULL", "new", "delete",
+};
+const std::string_view GEN_OPERATORS[] = {
+  "+", "-", "*", "/", "%", "(", ")", "{", "}", "[", "]", ",", ";", "&",
+  "<", ">", "<=", ">=", "==", "!=", "=",
+};
+
+struct Generator {
+  std::mt19937 rng;
+
+  explicit Generator(unsigned seed) : rng(seed) {}
+
+  int pick(int n) {
+    return std::uniform_int_distribution<int>(0, n - 1)(rng);
+  }
+
+  void identifier(std::string& out) {
+    if (pick(8) == 0) {
+      out += GEN_KEYWORDS[pick(std::size(GEN_KEYWORDS))];
+      return;
+    }
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static const char alnum[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    out += letters[pick(52)];
+    for (int n = pick(12); n > 0; --n) out += alnum[pick(62)];
+  }
+
+  void number(std::string& out) {
+    if (pick(10) == 0) out += '0';
+    else out += std::to_string(std::uniform_int_distribution<int>(1, 2147483647)(rng) >> pick(31));
+  }
+
+  void op(std::string& out) {
+    std::string_view o = GEN_OPERATORS[pick(std::size(GEN_OPERATORS))];
+    out += o;
+    // Keep "/" from running into a following "/" and starting a comment.
+    if (o == "/") out += ' ';
+  }
+
+  void comment(std::string& out) {
+    out += "//";
+    for (int n = 20 + pick(100); n > 0; --n) out += char(' ' + pick(95));
+  }
+
+  // One line of a statement from a typical program.
+  void statement(std::string& out) {
+    out += "  ";
+    identifier(out);
+    out += " = ";
+    for (int n = 1 + pick(4); n > 0; --n) {
+      if (pick(2)) identifier(out);
+      else number(out);
+      out += n > 1 ? " + " : ";";
+    }
+    if (pick(4) == 0) {
+      out += ' ';
+      comment(out);
+    }
+  }
+
+  // Appends one line of source for mix.
+  void line(std::string_view mix, std::string& out) {
+    if (mix == "id" || mix == "num") {
+      for (int n = 8 + pick(8); n > 0; --n) {
+        if (mix == "id") identifier(out);
+        else number(out);
+        out += ' ';
+      }
+    } else if (mix == "comment") {
+      if (pick(4) == 0) statement(out);
+      else comment(out);
+    } else if (mix == "op") {
+      for (int n = 20 + pick(20); n > 0; --n) {
+        if (pick(3) == 0) identifier(out);
+        op(out);
+      }
+    } else {
+      statement(out);
+    }
+    out += '\n';
+  }
+};
+
+std::string generateSource(std::string_view mix, size_t bytes, unsigned seed) {
+  Generator gen(seed);
+  std::string out;
+  out.reserve(bytes + 256);
+  while (out.size() < bytes) gen.line(mix, out);
+  return out;
+}
+
+void runBenchmark(std::string_view mix, size_t bytes, int reps, unsigned seed) {
+  std::string text = generateSource(mix, bytes, seed);
+  size_t tokens = 0, errors = 0, checksum = 0;
+  size_t allocations_before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < reps; ++i) {
+    scanText(text, [&](int kind, std::string_view lexeme) {
+      ++tokens;
+      checksum += kind + lexeme.size();
+    }, [&](const char*) { ++errors; });
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  size_t allocated = allocations - allocations_before;
+  std::printf("%-8s %8.1f MB %10zu tokens %8.1f MB/s %8.2f Mtok/s %6.3f alloc/tok %zu err (%zx)\n",
+              std::string(mix).c_str(), text.size() / 1e6, tokens / reps,
+              text.size() * double(reps) / seconds / 1e6, tokens / seconds / 1e6,
+              tokens ? double(allocated) / tokens : 0.0, errors / reps, checksum);
+}
+
+// Tokens as IncrementalScanner reports them, scan errors included.
+using TokenList = std::vector<std::pair<int, std::string>>;
+
+TokenList scanAll(std::string_view text) {
+  TokenList tokens;
+  scanText(text, [&](int kind, std::string_view lexeme) {
+    tokens.emplace_back(kind, lexeme);
+  }, [&](const char* message, std::string_view lexeme) {
+    tokens.emplace_back(std::string_view(message) == "ERROR RANGE" ? SCAN_RANGE_ERROR : SCAN_ERROR, lexeme);
+  });
+  return tokens;
+}
+
+bool runEdits(std::string_view mix, size_t bytes, int edits, unsigned seed) {
+  static const std::string_view snippets[] = {
+    "x", "42", " ", "\n", "+ 1", "//", "/", "int y = 0;\n", "wain", "99999999999", "$", "a\nb",
+  };
+  Generator gen(seed);
+  IncrementalScanner scanner;
+  scanner.load(generateSource(mix, bytes, seed));
+  size_t rescanned = 0;
+  bool ok = true;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < edits; ++i) {
+    size_t line = gen.pick(int(scanner.lines.size()));
+    const std::string& text = scanner.lines[line].text;
+    size_t column = gen.pick(int(text.size()) + 1);
+    // Up to the end of the next line, so some edits join lines.
+    size_t available = text.size() - column;
+    if (line + 1 < scanner.lines.size()) available += 1 + scanner.lines[line + 1].text.size();
+    size_t removed = std::min<size_t>(available, gen.pick(4) == 0 ? gen.pick(int(available) + 1) : gen.pick(4));
+    std::string_view inserted = gen.pick(3) == 0 ? std::string_view() : snippets[gen.pick(std::size(snippets))];
+    if (i % 16 == 15) {
+      // Past the end of the line or of the buffer.
+      if (gen.pick(2)) ok = scanner.edit(line, text.size() + 1, 0, inserted) == 0 && ok;
+      else ok = scanner.edit(scanner.lines.size(), 0, 0, inserted) == 0 && ok;
+      continue;
+    }
+    size_t count = scanner.edit(line, column, removed, inserted);
+    ok = count > 0 && ok;
+    rescanned += count;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::string text;
+  for (size_t i = 0; i < scanner.lines.size(); ++i) {
+    if (i > 0) text += '\n';
+    text += scanner.lines[i].text;
+  }
+  TokenList incremental;
+  scanner.forEachToken([&](int kind, std::string_view lexeme) {
+    incremental.emplace_back(kind, lexeme);
+  });
+  ok = ok && incremental == scanAll(text);
+  std::printf("%-8s %8d edits %8.2f us/edit %6.2f lines/edit %s\n",
+              std::string(mix).c_str(), edits, seconds / std::max(edits, 1) * 1e6,
+              double(rescanned) / std::max(edits, 1), ok ? "match" : "MISMATCH");
+  return ok;
+}
+
+int main(int argc, char* argv[]) {
+  double megabytes = 16;
+  int reps = 5;
+  unsigned seed = 1;
+  int edits = 0;
+  std::vector<std::string_view> mixes;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--size" && i + 1 < argc) megabytes = std::atof(argv[++i]);
+    else if (arg == "--reps" && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--seed" && i + 1 < argc) seed = std::atoi(argv[++i]);
+    else if (arg == "--edits" && i + 1 < argc) edits = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "id" || arg == "num" || arg == "comment" || arg == "op" || arg == "mixed") mixes.push_back(arg);
+    else {
+      std::fprintf(stderr, "usage: wlp4scanbench [--size MB] [--reps N] [--seed S] [--edits N] [id|num|comment|op|mixed...]\n");
+      return 1;
+    }
+  }
+  if (mixes.empty()) mixes = {"id", "num", "comment", "op", "mixed"};
+  bool ok = true;
+  for (std::string_view mix : mixes) {
+    runBenchmark(mix, size_t(megabytes * 1e6), reps, seed);
+    if (edits > 0) ok = runEdits(mix, size_t(megabytes * 1e6), edits, seed) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <string>
+#include "wlp4scan.h"
+
+// Writes wlp4scan_direct.h, the minimized scanner DFA from wlp4scan.h as
+// direct-coded C++: one labelled block per state that switches on the
+// next byte and jumps to the next state's block. As in re2c, a state that
+// loops on itself over a large byte class (identifiers, numbers) first
+// runs a tight loop over a 256-entry bitmap instead of going through the
+// switch for every byte.
+//
+// Building with -DWLP4SCAN_DIRECT makes scanText use it instead of the
+// transition table. Rerun after changing wlp4_dfa; the generated file
+// carries a fingerprint of the tables, so a stale copy fails to compile.
+//
+// Usage: wlp4scangen > wlp4scan_direct.h
+// Build: g++ -std=c++20 -O2 wlp4scangen.cpp -o wlp4scangen
+
+std::string byteLiteral(int c) {
+  if (c == '\'' || c == '\\') return std::string("'\\") + char(c) + "'";
+  if (c > ' ' && c < 127) return std::string("'") + char(c) + "'";
+  return std::to_string(c);
+}
+
+int main() {
+  bool targeted[NUM_STATES] = {};
+  for (int s = 0; s < NUM_STATES; ++s) {
+    for (int c = 0; c < 256; ++c) {
+      if (dfa.next(s, c) != DEAD_STATE) targeted[dfa.next(s, c)] = true;
+    }
+  }
+
+  std::printf("// Generated by wlp4scangen from the DFA in wlp4scan.h. Do not edit.\n");
+  std::printf("#ifndef WLP4SCAN_DIRECT_H\n#define WLP4SCAN_DIRECT_H\n\n");
+  std::printf("constexpr unsigned long long DIRECT_DFA_FINGERPRINT = %lluull;\n\n",
+              (unsigned long long) dfaFingerprint(dfa));
+  // Self-loops over at least this many bytes get a bitmap loop.
+  const int LOOP_THRESHOLD = 8;
+  bool has_loop[NUM_STATES] = {};
+  for (int s = 0; s < NUM_STATES; ++s) {
+    int count = 0;
+    for (int c = 0; c < 256; ++c) count += dfa.next(s, c) == s;
+    if (count < LOOP_THRESHOLD) continue;
+    has_loop[s] = true;
+    std::printf("constexpr bool direct_loop%d[256] = {", s);
+    for (int c = 0; c < 256; ++c) std::printf("%s%d", c == 0 ? "\n  " : c % 32 ? ", " : ",\n  ", dfa.next(s, c) == s);
+    std::printf("\n};\n\n");
+  }
+
+  std::printf("// Same contract as DfaTables::longestMatch on the scanner DFA.\n");
+  std::printf("inline DfaMatch directLongestMatch(const char* p, const char* end) {\n");
+  // The start state comes first, so the function falls into it.
+  for (int s = 0; s < NUM_STATES; ++s) {
+    if (targeted[s]) std::printf("state%d:\n", s);
+    std::printf("  // %.*s\n", int(dfa.state_names[s].size()), dfa.state_names[s].data());
+    if (has_loop[s]) std::printf("  while (p != end && direct_loop%d[(unsigned char) *p]) ++p;\n", s);
+    bool has_transitions = false;
+    for (int c = 0; c < 256; ++c) {
+      int t = dfa.next(s, c);
+      if (t != DEAD_STATE && !(t == s && has_loop[s])) has_transitions = true;
+    }
+    if (!has_transitions) {
+      std::printf("  return {p, %d};\n", s);
+      continue;
+    }
+    std::printf("  if (p == end) return {p, %d};\n", s);
+    std::printf("  switch ((unsigned char) *p) {\n");
+    // One case group per target state, with runs of bytes as ranges.
+    for (int t = 0; t < NUM_STATES; ++t) {
+      std::string cases;
+      for (int c = 0; c < 256; ++c) {
+        if (dfa.next(s, c) != t || (t == s && has_loop[s])) continue;
+        int last = c;
+        while (last + 1 < 256 && dfa.next(s, last + 1) == t) ++last;
+        cases += "  case " + byteLiteral(c);
+        if (last > c) cases += " ... " + byteLiteral(last);
+        cases += ":\n";
+        c = last;
+      }
+      if (!cases.empty()) std::printf("%s    ++p;\n    goto state%d;\n", cases.c_str(), t);
+    }
+    std::printf("  default:\n    return {p, %d};\n  }\n", s);
+  }
+  std::printf("}\n\n#endif\n");
+}
@@ -0,0 +1,148 @@
+#ifndef WLP4TOKENS_H
+#define WLP4TOKENS_H
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Token kinds produced by wlp4scan. A kind's index in this list is its
+// kind byte in the binary token stream.
+constexpr std::string_view TOKEN_KINDS[] = {
+    "ID", "NUM", "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACK", "RBRACK",
+    "BECOMES", "EQ", "NE", "LT", "GT", "LE", "GE", "PLUS", "MINUS", "STAR",
+    "SLASH", "PCT", "COMMA", "SEMI", "AMP", "WAIN", "INT", "IF", "ELSE",
+    "WHILE", "PRINTLN", "PUTCHAR", "GETCHAR", "RETURN", "NULL", "NEW", "DELETE",
+};
+constexpr int NUM_TOKEN_KINDS = sizeof(TOKEN_KINDS) / sizeof(TOKEN_KINDS[0]);
+
+constexpr int tokenKindId(std::string_view name) {
+    for (int i = 0; i < NUM_TOKEN_KINDS; ++i) {
+        if (TOKEN_KINDS[i] == name) return i;
+    }
+    return -1;
+}
+
+// Binary token stream, written by "wlp4scan --binary" and accepted by
+// wlp4parse in place of the text format. All integers are uint32 in host
+// byte order.
+//
+//   header   TOKEN_STREAM_MAGIC, lexeme count, lexeme bytes, token count,
+//            record width
+//   lexemes  one end offset per lexeme, then the concatenated lexeme bytes
+//            (padded to 4 bytes)
+//   tokens   one fixed-width record per token: the kind byte followed by
+//            the lexeme index in little-endian order
+//
+// Lexemes are interned, so each distinct spelling is stored once. The
+// record width is the smallest of 2, 3 or 4 bytes that can hold every
+// lexeme index in the stream.
+constexpr char TOKEN_STREAM_MAGIC[8] = {'\x7f', 'W', 'L', 'P', '4', 'T', 'O', 'K'};
+constexpr uint32_t MAX_STREAM_LEXEMES = 1u << 24;
+
+struct TokenStreamWriter {
+    std::unordered_map<std::string_view, uint32_t> lexeme_ids;
+    std::vector<std::string_view> lexemes;
+    std::vector<uint32_t> kinds;
+    std::vector<uint32_t> indices;
+
+    // The lexeme must stay alive until write() is called.
+    bool add(int kind, std::string_view lexeme) {
+        auto [it, inserted] = lexeme_ids.try_emplace(lexeme, uint32_t(lexemes.size()));
+        if (inserted) {
+            if (lexemes.size() == MAX_STREAM_LEXEMES) return false;
+            lexemes.push_back(lexeme);
+        }
+        kinds.push_back(uint32_t(kind));
+        indices.push_back(it->second);
+        return true;
+    }
+
+    void write(std::ostream& out) const {
+        std::vector<uint32_t> ends;
+        uint32_t total = 0;
+        for (auto lexeme : lexemes) ends.push_back(total += uint32_t(lexeme.size()));
+        uint32_t width = lexemes.size() <= (1u << 8) ? 2 : lexemes.size() <= (1u << 16) ? 3 : 4;
+        uint32_t header[4] = {uint32_t(lexemes.size()), total, uint32_t(kinds.size()), width};
+        out.write(TOKEN_STREAM_MAGIC, sizeof(TOKEN_STREAM_MAGIC));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(ends.data()), ends.size() * 4);
+        for (auto lexeme : lexemes) out.write(lexeme.data(), lexeme.size());
+        out.write("\0\0\0", (4 - total % 4) % 4);
+        std::string records(kinds.size() * width, '\0');
+        for (size_t i = 0; i < kinds.size(); ++i) {
+            char* record = &records[i * width];
+            record[0] = char(kinds[i]);
+            for (uint32_t b = 1; b < width; ++b) record[b] = char(indices[i] >> (8 * (b - 1)));
+        }
+        out.write(records.data(), records.size());
+    }
+};
+
+struct TokenStreamReader {
+    std::string data;
+    const uint32_t* ends = nullptr;
+    const char* lexeme_bytes = nullptr;
+    const unsigned char* records = nullptr;
+    uint32_t num_lexemes = 0;
+    uint32_t num_tokens = 0;
+    uint32_t width = 0;
+
+    static bool isBinary(std::istream& in) {
+        return in.peek() == (unsigned char) TOKEN_STREAM_MAGIC[0];
+    }
+
+    // Reads a whole stream; returns false if it is truncated or malformed.
+    bool read(std::istream& in) {
+        char buffer[1 << 16];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) data.append(buffer, in.gcount());
+        const size_t header_size = sizeof(TOKEN_STREAM_MAGIC) + 16;
+        if (data.size() < header_size || std::memcmp(data.data(), TOKEN_STREAM_MAGIC, sizeof(TOKEN_STREAM_MAGIC)) != 0) return false;
+        uint32_t header[4];
+        std::memcpy(header, data.data() + sizeof(TOKEN_STREAM_MAGIC), sizeof(header));
+        num_lexemes = header[0];
+        num_tokens = header[2];
+        width = header[3];
+        if (width < 2 || width > 4) return false;
+        size_t padded_bytes = (size_t(header[1]) + 3) / 4 * 4;
+        size_t expected = header_size + size_t(num_lexemes) * 4 + padded_bytes + size_t(num_tokens) * width;
+        if (data.size() != expected) return false;
+        // std::string storage is suitably aligned and every section starts
+        // on a 4-byte boundary.
+        const char* p = data.data() + header_size;
+        ends = reinterpret_cast<const uint32_t*>(p);
+        p += size_t(num_lexemes) * 4;
+        lexeme_bytes = p;
+        p += padded_bytes;
+        records = reinterpret_cast<const unsigned char*>(p);
+        for (uint32_t i = 0; i < num_lexemes; ++i) {
+            if (ends[i] > header[1] || (i > 0 && ends[i] < ends[i - 1])) return false;
+        }
+        for (uint32_t i = 0; i < num_tokens; ++i) {
+            if (kind(i) >= NUM_TOKEN_KINDS || lexemeId(i) >= num_lexemes) return false;
+        }
+        return true;
+    }
+
+    int kind(uint32_t token) const {
+        return records[size_t(token) * width];
+    }
+
+    uint32_t lexemeId(uint32_t token) const {
+        const unsigned char* record = records + size_t(token) * width;
+        uint32_t id = 0;
+        for (uint32_t b = width - 1; b > 0; --b) id = id << 8 | record[b];
+        return id;
+    }
+
+    std::string_view lexeme(uint32_t token) const {
+        uint32_t id = lexemeId(token);
+        uint32_t begin = id == 0 ? 0 : ends[id - 1];
+        return std::string_view(lexeme_bytes + begin, ends[id] - begin);
+    }
+};
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef WLP4TREE_H
+#define WLP4TREE_H
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Parse trees as read and written by wlp4type and wlp4gen: one line per
+// node in preorder, "token child-tokens..." for nonterminals and "token
+// lexeme" for terminals, optionally followed by " : type".
+//
+// The list nonterminals are held flat in memory. A statements node's
+// children are all of its statements, a dcls node's are one "dcl BECOMES
+// NUM|NULL SEMI" group per declaration, and a procedures node's are all
+// the procedures followed by main, each in source order, instead of a
+// spine with one list node per item. readTree accepts the standard nested
+// form as well as the flat form written by wlp4parse --flat; printTree
+// writes either. Reading, printing and walking keep their own stacks
+// rather than recursing, so tree depth is bounded by memory, not by the
+// call stack.
+
+struct TreeNode {
+    std::string token;
+    std::string lexeme;
+    int num_children;
+    std::vector<TreeNode*> children;
+    bool type_annotated = false;
+    std::string type_annotation;
+};
+
+inline bool isTreeTerminal(std::string_view token) {
+    static const std::unordered_set<std::string_view> terminals = {
+        "BOF", "EOF", "WAIN", "LPAREN", "INT", "COMMA", "RPAREN", "LBRACE", "RETURN", "SEMI", "RBRACE",
+        "STAR", "ID", "NUM", "NULL", ".EMPTY", "PLUS", "MINUS", "SLASH", "PCT", "AMP", "NEW", "LBRACK",
+        "RBRACK", "BECOMES", "GETCHAR", "WHILE", "PRINTLN", "PUTCHAR", "DELETE", "EQ", "NE", "LT", "LE",
+        "GE", "GT", "IF", "ELSE",
+    };
+    return terminals.contains(token);
+}
+
+// In the standard form statements and dcls recurse on their first child
+// and procedures on its last.
+inline bool isLeftList(std::string_view token) {
+    return token == "statements" || token == "dcls";
+}
+
+inline bool isRightList(std::string_view token) {
+    return token == "procedures";
+}
+
+// Number of children one dcls or statements item has.
+inline size_t listGroupSize(std::string_view token) {
+    return token == "dcls" ? 4 : 1;
+}
+
+// Reads one line into node, without its children; child_tokens gets the
+// tokens the line lists for them. Past the end of the input node is left
+// a leaf.
+inline void readTreeLine(std::istream& in, TreeNode* node, std::vector<std::string>& child_tokens) {
+    std::string s;
+    child_tokens.clear();
+    if (!std::getline(in, s)) return;
+    std::istringstream iss{s};
+    std::string child;
+    iss >> node->token;
+    iss >> child;
+    if (isTreeTerminal(node->token) || child == ".EMPTY") {
+        node->lexeme = child;
+        iss >> child;
+    }
+    else {
+        child_tokens.push_back(child);
+        while (iss >> child && child != ":") child_tokens.push_back(child);
+    }
+    if (child == ":" && iss >> node->type_annotation) node->type_annotated = true;
+}
+
+// A node whose children are still being read: remaining more subtrees
+// follow, and then another procedures spine line if more_spine is set.
+struct TreeReadFrame {
+    TreeNode* node;
+    size_t remaining = 0;
+    bool more_spine = false;
+};
+
+// Sets frame up for the procedures spine line in child_tokens.
+inline void readRightListLevel(TreeReadFrame& frame, const std::vector<std::string>& child_tokens) {
+    frame.more_spine = !child_tokens.empty() && child_tokens.back() == frame.node->token;
+    frame.remaining = child_tokens.size() - frame.more_spine;
+}
+
+// Reads node's line, and for a nested list every spine line that comes
+// before its items, and says what follows.
+inline TreeReadFrame readTreeNode(std::istream& in, TreeNode* node, std::vector<std::string>& child_tokens, bool& flat_lists) {
+    readTreeLine(in, node, child_tokens);
+    TreeReadFrame frame{node, child_tokens.size()};
+    TreeNode spine;
+    if (isLeftList(node->token) && !child_tokens.empty() && child_tokens[0] == node->token) {
+        // The spine lines come first, outermost first; then the innermost
+        // list's own children and each level's items, innermost first.
+        size_t items = 0;
+        while (!child_tokens.empty() && child_tokens[0] == node->token) {
+            items += child_tokens.size() - 1;
+            readTreeLine(in, &spine, child_tokens);
+        }
+        frame.remaining = items + child_tokens.size();
+    }
+    else if (isRightList(node->token) && !child_tokens.empty() && child_tokens.back() == node->token) {
+        readRightListLevel(frame, child_tokens);
+    }
+    else {
+        if (isLeftList(node->token) && !child_tokens.empty()) flat_lists = true;
+        if (isRightList(node->token) && child_tokens.size() > 1) flat_lists = true;
+    }
+    return frame;
+}
+
+// Reads a tree, collapsing list spines as it goes. flat_lists is set when
+// the input turns out to use the flat form. The nodes being filled in are
+// kept on an explicit stack, so any depth fits.
+inline TreeNode* readTree(std::istream& in, bool& flat_lists) {
+    std::vector<std::string> child_tokens;
+    TreeNode* root = new TreeNode{};
+    std::vector<TreeReadFrame> frames{readTreeNode(in, root, child_tokens, flat_lists)};
+    while (!frames.empty()) {
+        TreeReadFrame& frame = frames.back();
+        if (frame.remaining == 0 && frame.more_spine) {
+            TreeNode spine;
+            readTreeLine(in, &spine, child_tokens);
+            readRightListLevel(frame, child_tokens);
+            continue;
+        }
+        if (frame.remaining == 0) {
+            frame.node->num_children = int(frame.node->children.size());
+            frames.pop_back();
+            continue;
+        }
+        --frame.remaining;
+        TreeNode* child = new TreeNode{};
+        frame.node->children.push_back(child);
+        frames.push_back(readTreeNode(in, child, child_tokens, flat_lists));
+    }
+    return root;
+}
+
+inline void printTreeLine(std::ostream& out, const TreeNode* node) {
+    out << node->token;
+    for (auto it: node->children) out << " " << it->token;
+    out << " " << node->lexeme;
+    if (node->type_annotated) out << " : " << node->type_annotation;
+    out << "\n";
+}
+
+// Writes a tree, in the standard form unless flat_lists is set. A pending
+// entry with a spine_item is the procedures spine line for that item,
+// which is followed by the item's subtree.
+inline void printTree(std::ostream& out, const TreeNode* root, bool flat_lists) {
+    constexpr size_t NO_SPINE = size_t(-1);
+    struct Pending {
+        const TreeNode* node;
+        size_t spine_item;
+    };
+    std::vector<Pending> pending{{root, NO_SPINE}};
+    while (!pending.empty()) {
+        auto [node, spine_item] = pending.back();
+        pending.pop_back();
+        if (spine_item != NO_SPINE) {
+            bool last = spine_item + 1 == node->children.size();
+            out << node->token << " " << node->children[spine_item]->token;
+            if (!last) out << " " << node->token;
+            out << " \n";
+            if (!last) pending.push_back({node, spine_item + 1});
+            pending.push_back({node->children[spine_item], NO_SPINE});
+            continue;
+        }
+        if (!flat_lists && isLeftList(node->token) && !node->children.empty()) {
+            size_t group = listGroupSize(node->token);
+            for (size_t level = node->children.size() / group; level > 0; --level) {
+                out << node->token << " " << node->token;
+                for (size_t i = (level - 1) * group; i < level * group; ++i) out << " " << node->children[i]->token;
+                out << " \n";
+            }
+            out << node->token << " .EMPTY\n";
+        }
+        else if (!flat_lists && isRightList(node->token) && node->children.size() > 1) {
+            pending.push_back({node, 0});
+            continue;
+        }
+        else printTreeLine(out, node);
+        for (size_t i = node->children.size(); i-- > 0; ) pending.push_back({node->children[i], NO_SPINE});
+    }
+}
+
+inline void deleteTree(TreeNode* root) {
+    std::vector<TreeNode*> pending{root};
+    while (!pending.empty()) {
+        TreeNode* node = pending.back();
+        pending.pop_back();
+        pending.insert(pending.end(), node->children.begin(), node->children.end());
+        delete node;
+    }
+}
+
+// What a walkTree visitor wants done after seeing a node.
+enum TreeWalk {WALK_CHILDREN, WALK_SKIP_CHILDREN, WALK_STOP};
+
+// Visits a subtree in preorder, children left to right, off an explicit
+// stack. Returns false if the visitor stopped the walk.
+template <typename Visit>
+bool walkTree(TreeNode* root, Visit visit) {
+    std::vector<TreeNode*> pending{root};
+    while (!pending.empty()) {
+        TreeNode* node = pending.back();
+        pending.pop_back();
+        TreeWalk next = visit(node);
+        if (next == WALK_STOP) return false;
+        if (next == WALK_CHILDREN) pending.insert(pending.end(), node->children.rbegin(), node->children.rend());
+    }
+    return true;
+}
+
+// Visits every node of a subtree after its children, left to right.
+template <typename Visit>
+void walkTreePostorder(TreeNode* root, Visit visit) {
+    std::vector<std::pair<TreeNode*, size_t>> pending{{root, 0}};
+    while (!pending.empty()) {
+        auto& [node, next_child] = pending.back();
+        if (next_child < node->children.size()) {
+            TreeNode* child = node->children[next_child++];
+            pending.push_back({child, 0});
+        }
+        else {
+            visit(node);
+            pending.pop_back();
+        }
+    }
+}
+
+#endif
@@ -1,62 +1,38 @@
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <iterator>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
 #include <unordered_map>
+#include "wlp4ast.h"
+#include "wlp4tree.h"
 
-struct TreeNode {
-    std::string token;
-    std::string lexeme;
-    int num_children;
-    std::vector<TreeNode*> children;
-    bool type_annotated = false;
-    std::string type_annotation;
-};
-
-bool exprCheck(TreeNode* expr_node, std::unordered_map<std::string, std::string>& sym_table);
-bool factorCheck(TreeNode* factor_node, std::unordered_map<std::string, std::string>& sym_table);
-bool lvalueCheck(TreeNode* lvalue_node, std::unordered_map<std::string, std::string>& sym_table);
-bool termCheck(TreeNode* term_node, std::unordered_map<std::string, std::string>& sym_table);
-bool statementCheck(TreeNode* statement_node, std::unordered_map<std::string, std::string>& sym_table);
-bool testCheck(TreeNode* test_node, std::unordered_map<std::string, std::string>& sym_table);
-bool multipleStatementsCheck(TreeNode* statement_node, std::unordered_map<std::string, std::string>& sym_table);
-
-std::unordered_set<std::string> terminals;
 std::unordered_map<std::string, std::unordered_map<std::string, std::string>> symbol_table;
 std::vector<std::string> procedure_order;
 std::unordered_map<std::string, std::vector<std::string>> functionInfo;
 
-void deleteNode(TreeNode* node) {
-    for (auto it: node->children) {
-        deleteNode(it);
-    }
-    delete node;
-}
-
-void typeAnnotate(TreeNode* node, std::unordered_map<std::string, std::string>& sym_table) {
-    for (auto it: node->children) typeAnnotate(it, sym_table);
-
+// A node's type follows from its children's, so each node is annotated
+// once, after its children.
+void typeAnnotateNode(TreeNode* node, std::unordered_map<std::string, std::string>& sym_table) {
     if (node->token == "dcl") {
         bool is_normal_int = node->children[0]->children.size() == 1;
         node->children[1]->type_annotated = true;
         node->children[1]->type_annotation = is_normal_int ? "int" : "int*";
-        for (auto it: node->children) typeAnnotate(it, sym_table);
     }
 
-    else if (node->token == "dcls" && node->children.size() > 0) {
-        node->children[3]->type_annotated = true;
-        node->children[3]->type_annotation = node->children[1]->children[1]->type_annotation;
+    else if (node->token == "dcls") {
+        for (size_t i = 0; i < node->children.size(); i += 4) {
+            node->children[i + 2]->type_annotated = true;
+            node->children[i + 2]->type_annotation = node->children[i]->children[1]->type_annotation;
+        }
     }
 
     else if (node->token == "expr" || node->token == "term") {
         if (node->children.size() == 1) {
-            typeAnnotate(node->children[0], sym_table);
             node->type_annotated = true;
             node->type_annotation = node->children[0]->type_annotation;
         }
         else {
-            typeAnnotate(node->children[0], sym_table);
-            typeAnnotate(node->children[2], sym_table);
             node->type_annotated = true;
             if (node->children[0]->type_annotation == node->children[2]->type_annotation) {
                 if (node->children[1]->token == "MINUS" && node->children[0]->type_annotation == "int*") {
@@ -79,18 +55,6 @@ void typeAnnotate(TreeNode* node, std::unordered_map<std::string, std::string>&
                 node->children[0]->type_annotation = sym_table[node->children[0]->lexeme];
             }
         }
-        
-        else if (node->children.size() == 2) {
-            typeAnnotate(node->children[1], sym_table);
-        }
-
-        else if (node->children.size() == 3) {
-            if (node->children[0]->token == "LPAREN") {
-                typeAnnotate(node->children[1], sym_table);
-            }
-        }
-
-        else if (node->children.size() == 5) typeAnnotate(node->children[3], sym_table);
 
         node->type_annotated = true;
 
@@ -110,10 +74,6 @@ void typeAnnotate(TreeNode* node, std::unordered_map<std::string, std::string>&
             node->children[0]->type_annotation = sym_table[node->children[0]->lexeme];
         }
 
-        else {
-            typeAnnotate(node->children[1], sym_table);
-        }
-
         node->type_annotated = true;
 
         if (node->children.size() == 1) {
@@ -128,103 +88,36 @@ void typeAnnotate(TreeNode* node, std::unordered_map<std::string, std::string>&
     }
 }
 
-void typeAnnotateAllProcedures(TreeNode* head) {
-    while (head->children.size() > 1) {
-        std::unordered_map<std::string, std::string>& sym_table = symbol_table[head->children[0]->children[1]->lexeme];
-        typeAnnotate(head->children[0], sym_table);
-        head = head->children[1];
-    }
-    typeAnnotate(head->children[0], symbol_table["wain"]);
-}
-
-void printParseTree(TreeNode* node) {
-    std::cout << node->token;
-    for (auto it: node->children) {
-        std::cout << " " << it->token;
-    }
-    std::cout << " " << node->lexeme;
-    if (node->type_annotated) {
-        std::cout << " : " << node->type_annotation;
-    }
-    std::cout << std::endl;
-    for (auto it: node->children) {
-        printParseTree(it);
-    }
-}
-
-bool lvalueCheck(TreeNode* lvalue_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (lvalue_node->children.size() == 1) return sym_table.contains(lvalue_node->children[0]->lexeme);
-    if (lvalue_node->children.size() == 2) return factorCheck(lvalue_node->children[1], sym_table);
-    return lvalueCheck(lvalue_node->children[1], sym_table);
-}
-
-bool factorCheck(TreeNode* factor_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (factor_node->children.size() == 1) {
-        if (factor_node->children[0]->token == "ID" && !sym_table.contains(factor_node->children[0]->lexeme)) return false;
-        return true;
-    }
-
-    if (factor_node->children.size() == 2) {
-        if (factor_node->children[0]->token == "AMP") return lvalueCheck(factor_node->children[1], sym_table);
-        else return factorCheck(factor_node->children[1], sym_table);
-    }
-
-    if (factor_node->children.size() == 3) {
-        if (factor_node->children[0]->token == "ID") return symbol_table.contains(factor_node->children[0]->lexeme);
-        else if (factor_node->children[0]->token == "GETCHAR") return true;
-        return exprCheck(factor_node->children[1], sym_table);
-    }
-
-    if (factor_node->children.size() == 4) {
-        return symbol_table.contains(factor_node->children[0]->lexeme);
-    }
-
-    return exprCheck(factor_node->children[3], sym_table);
-}
-
-bool termCheck(TreeNode* term_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (term_node->children.size() == 1) return factorCheck(term_node->children[0], sym_table);
-    if (!factorCheck(term_node->children[2], sym_table)) return false;
-    return termCheck(term_node->children[0], sym_table);
-}
-
-bool exprCheck(TreeNode* expr_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (expr_node->children.size() == 1) return termCheck(expr_node->children[0], sym_table);
-
-    if (!termCheck(expr_node->children[2], sym_table)) return false;
-
-    return exprCheck(expr_node->children[0], sym_table);
+void typeAnnotate(TreeNode* node, std::unordered_map<std::string, std::string>& sym_table) {
+    walkTreePostorder(node, [&](TreeNode* it) { typeAnnotateNode(it, sym_table); });
 }
 
-bool statementCheck(TreeNode* statement_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (statement_node->children.size() == 4) {
-        return lvalueCheck(statement_node->children[0], sym_table) && exprCheck(statement_node->children[2], sym_table);
-    }
-    if (statement_node->children.size() == 5) {
-        if (statement_node->children[0]->token == "DELETE") return exprCheck(statement_node->children[3], sym_table);
-        else return exprCheck(statement_node->children[2], sym_table);
-    }
-    if (statement_node->children.size() == 7) {
-        return testCheck(statement_node->children[2], sym_table) && multipleStatementsCheck(statement_node->children[5], sym_table);
+void typeAnnotateAllProcedures(TreeNode* procedures) {
+    for (size_t i = 0; i + 1 < procedures->children.size(); ++i) {
+        TreeNode* procedure = procedures->children[i];
+        typeAnnotate(procedure, symbol_table[procedure->children[1]->lexeme]);
     }
-    else {
-        return testCheck(statement_node->children[2], sym_table) && multipleStatementsCheck(statement_node->children[5], sym_table) && multipleStatementsCheck(statement_node->children[9], sym_table);
-    }
-}
-
-bool testCheck(TreeNode* test_node, std::unordered_map<std::string, std::string>& sym_table) {
-    return exprCheck(test_node->children[0], sym_table) && exprCheck(test_node->children[2], sym_table);
+    typeAnnotate(procedures->children.back(), symbol_table["wain"]);
 }
 
-bool multipleStatementsCheck(TreeNode* statement_node, std::unordered_map<std::string, std::string>& sym_table) {
-    if (statement_node->children.size() == 0) return true;
-    if (!statementCheck(statement_node->children[1], sym_table)) return false;
-    return multipleStatementsCheck(statement_node->children[0], sym_table);
+// Whether every variable a subtree uses is in sym_table and every
+// procedure it calls is declared. Call arguments are not looked at.
+bool declarationsCheck(TreeNode* node, std::unordered_map<std::string, std::string>& sym_table) {
+    return walkTree(node, [&](TreeNode* it) {
+        if (it->token == "factor" && it->children[0]->token == "ID") {
+            if (it->children.size() == 1) return sym_table.contains(it->children[0]->lexeme) ? WALK_CHILDREN : WALK_STOP;
+            return symbol_table.contains(it->children[0]->lexeme) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        }
+        if (it->token == "lvalue" && it->children.size() == 1) {
+            return sym_table.contains(it->children[0]->lexeme) ? WALK_CHILDREN : WALK_STOP;
+        }
+        return WALK_CHILDREN;
+    });
 }
 
 bool semanticCheck(TreeNode* main_node) {
     TreeNode* statements = main_node->children[1]->token == "WAIN" ? main_node->children[9] : main_node->children[7];
-    if (!multipleStatementsCheck(statements, symbol_table[main_node->children[1]->lexeme])) return false;
+    if (!declarationsCheck(statements, symbol_table[main_node->children[1]->lexeme])) return false;
 
     if (main_node->children[1]->token == "WAIN") {
         std::string first_param_name = main_node->children[3]->children[1]->lexeme;
@@ -235,167 +128,145 @@ bool semanticCheck(TreeNode* main_node) {
 
         if (second_param->children[0]->children.size() > 1) return false;
 
-        return exprCheck(main_node->children[11], symbol_table["wain"]);
+        return declarationsCheck(main_node->children[11], symbol_table["wain"]);
     }
     else {
         //TreeNode* params = main_node->children[3];
         //if (!paramsSemanticCheck(params)) return false;
         // might have to semantic check dcls
-        return exprCheck(main_node->children[9], symbol_table[main_node->children[1]->lexeme]);
+        return declarationsCheck(main_node->children[9], symbol_table[main_node->children[1]->lexeme]);
     }
     
 }
 
-bool buildTable(TreeNode* node, int null_num_none, std::unordered_map<std::string, std::string>& sym_table) { // 1 = none, 2 = null, 3 = num
-    if (node->token == "dcls" && node->children.size() == 0) return true;
-
-    else if (node->token == "dcls") {
-        if (node->children[3]->token == "NUM") return buildTable(node->children[1], 3, sym_table) && buildTable(node->children[0], 1, sym_table);
-        else return buildTable(node->children[1], 2, sym_table) && buildTable(node->children[0], 1, sym_table);
-    }
+bool declareVariable(const std::string& var_name, bool is_normal_int, int null_num_none, std::unordered_map<std::string, std::string>& sym_table) { // 1 = none, 2 = null, 3 = num
+    if (sym_table.contains(var_name)) return false;
+    sym_table[var_name] = is_normal_int ? "int" : "int*";
 
-    else if (node->token == "dcl") {
-        bool is_normal_int = node->children[0]->children.size() == 1;
-        std::string var_name = node->children[1]->lexeme;
-        if (sym_table.contains(var_name)) return false;
-        sym_table[var_name] = is_normal_int ? "int" : "int*";
+    if ((is_normal_int && null_num_none == 2) || (!is_normal_int && null_num_none == 3)) return false;
 
-        if (is_normal_int && null_num_none == 2 || !is_normal_int && null_num_none == 3) return false;
+    return true;
+}
 
-        return true;
-    }
+bool addDeclaration(TreeNode* node, int null_num_none, std::unordered_map<std::string, std::string>& sym_table) {
+    return declareVariable(node->children[1]->lexeme, node->children[0]->children.size() == 1, null_num_none, sym_table);
+}
 
-    else {
-        if (node->token == "factor" && node->children.size() > 1 && node->children[0]->token == "ID") {
-            if (!symbol_table.contains(node->children[0]->lexeme)) return false;
+bool buildTable(TreeNode* node, std::unordered_map<std::string, std::string>& sym_table) {
+    return walkTree(node, [&](TreeNode* it) {
+        if (it->token == "dcls") {
+            for (size_t i = 0; i < it->children.size(); i += 4) {
+                if (!addDeclaration(it->children[i], it->children[i + 2]->token == "NUM" ? 3 : 2, sym_table)) return WALK_STOP;
+            }
+            return WALK_SKIP_CHILDREN;
         }
-        for (auto it: node->children) {
-            if (!buildTable(it, 1, sym_table)) return false;
+        if (it->token == "dcl") return addDeclaration(it, 1, sym_table) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        if (it->token == "factor" && it->children.size() > 1 && it->children[0]->token == "ID") {
+            if (!symbol_table.contains(it->children[0]->lexeme)) return WALK_STOP;
         }
-    }
-
-    return true;
+        return WALK_CHILDREN;
+    });
 }
 
-bool setupTables(TreeNode* node) {
-
-    if (node->children.size() == 1) {
-        symbol_table["wain"] = std::unordered_map<std::string, std::string>();
-        procedure_order.emplace_back("wain");
-        
-        functionInfo["wain"] = std::vector<std::string>();
-        if (node->children[0]->children[3]->children[0]->children.size() > 1) functionInfo["wain"].emplace_back("int*");
-        else functionInfo["wain"].emplace_back("int");
-        functionInfo["wain"].emplace_back("int");
-
-        return buildTable(node->children[0], 1, symbol_table["wain"]);
-    }
-
-    if (node->children[0]->children[1]->lexeme == "wain") return false;
-    if (symbol_table.contains(node->children[0]->children[1]->lexeme)) return false;
-    symbol_table[node->children[0]->children[1]->lexeme] = std::unordered_map<std::string, std::string>();
-
-    functionInfo[node->children[0]->children[1]->lexeme] = std::vector<std::string>();
-    if (node->children[0]->children[3]->children.size() > 0) {
-        TreeNode* tempParamIterator = node->children[0]->children[3]->children[0];
-        while (tempParamIterator->children.size() > 1) {
+bool setupTables(TreeNode* procedures) {
+    for (size_t i = 0; i + 1 < procedures->children.size(); ++i) {
+        TreeNode* procedure = procedures->children[i];
+        std::string name = procedure->children[1]->lexeme;
+        if (name == "wain") return false;
+        if (symbol_table.contains(name)) return false;
+        symbol_table[name] = std::unordered_map<std::string, std::string>();
+
+        functionInfo[name] = std::vector<std::string>();
+        if (procedure->children[3]->children.size() > 0) {
+            TreeNode* tempParamIterator = procedure->children[3]->children[0];
+            while (tempParamIterator->children.size() > 1) {
+                if (tempParamIterator->children[0]->children[0]->children.size() > 1) {
+                    functionInfo[name].emplace_back("int*");
+                }
+                else {
+                    functionInfo[name].emplace_back("int");
+                }
+                tempParamIterator = tempParamIterator->children[2];
+            }
             if (tempParamIterator->children[0]->children[0]->children.size() > 1) {
-                functionInfo[node->children[0]->children[1]->lexeme].emplace_back("int*");
+                functionInfo[name].emplace_back("int*");
             }
             else {
-                functionInfo[node->children[0]->children[1]->lexeme].emplace_back("int");
+                functionInfo[name].emplace_back("int");
             }
-            tempParamIterator = tempParamIterator->children[2];
-        }
-        if (tempParamIterator->children[0]->children[0]->children.size() > 1) {
-            functionInfo[node->children[0]->children[1]->lexeme].emplace_back("int*");
-        }
-        else {
-            functionInfo[node->children[0]->children[1]->lexeme].emplace_back("int");
-        }
-    }  
-
-    procedure_order.emplace_back(node->children[0]->children[1]->lexeme);
-    if (!buildTable(node->children[0], 1, symbol_table[node->children[0]->children[1]->lexeme])) return false;
-    return setupTables(node->children[1]);
-
-}
-
-void rebuildTree(TreeNode* node) {
-    std::string s;
-    std::getline(std::cin, s);
-    std::istringstream iss{s};
-    std::string child;
-    iss >> node->token;
-    iss >> child;
-    if (terminals.contains(node->token) || child == ".EMPTY") node->lexeme = child;
-    else {++node->num_children; while (!terminals.contains(node->token) && iss >> child) ++node->num_children;}
-    if (node->num_children > 0) {
-        for (int i = 0; i < node->num_children; ++i) {
-            TreeNode* child_node = new TreeNode{};
-            rebuildTree(child_node);
-            node->children.emplace_back(child_node);
         }
+
+        procedure_order.emplace_back(name);
+        if (!buildTable(procedure, symbol_table[name])) return false;
     }
+
+    TreeNode* main_node = procedures->children.back();
+    symbol_table["wain"] = std::unordered_map<std::string, std::string>();
+    procedure_order.emplace_back("wain");
+
+    functionInfo["wain"] = std::vector<std::string>();
+    if (main_node->children[3]->children[0]->children.size() > 1) functionInfo["wain"].emplace_back("int*");
+    else functionInfo["wain"].emplace_back("int");
+    functionInfo["wain"].emplace_back("int");
+
+    return buildTable(main_node, symbol_table["wain"]);
 }
 
 void formatError(std::string err_msg) {
     std::cerr << err_msg << std::endl;
 }
 
-bool checkReferencing(TreeNode* node) {
-    if (node->token == "factor" && node->children.size() == 2) {
-        if (node->children[0]->token == "STAR" && node->children[1]->type_annotation == "int") return false;
-        if (node->children[0]->token == "AMP" && node->children[1]->type_annotation == "int*") return false; // ADDED & CHECK
-    }
-    else if (node->token == "lvalue" && node->children.size() == 2) {
-        if (node->children[0]->token == "STAR" && node->children[1]->type_annotation == "int") return false;
-    }
-    for (auto it: node->children) {
-        if (!checkReferencing(it)) return false;
-    }
+bool checkReferencing(TreeNode* head) {
+    return walkTree(head, [](TreeNode* node) {
+        if (node->token == "factor" && node->children.size() == 2) {
+            if (node->children[0]->token == "STAR" && node->children[1]->type_annotation == "int") return WALK_STOP;
+            if (node->children[0]->token == "AMP" && node->children[1]->type_annotation == "int*") return WALK_STOP; // ADDED & CHECK
+        }
+        else if (node->token == "lvalue" && node->children.size() == 2) {
+            if (node->children[0]->token == "STAR" && node->children[1]->type_annotation == "int") return WALK_STOP;
+        }
+        return WALK_CHILDREN;
+    });
+}
+
+// Whether a call's arguments match the parameter types of the procedure.
+bool checkCallArguments(TreeNode* node) {
+    std::string function_name = node->children[0]->lexeme;
+    if (node->children.size() == 3) return functionInfo[function_name].size() == 0;
+    size_t counter = 0; TreeNode* temp = node->children[2];
+    while (temp->children.size() > 1) {
+        if (counter >= functionInfo[function_name].size()) return false;
+        if (temp->children[0]->type_annotation != functionInfo[function_name][counter]) return false;
+        ++counter;
+        temp = temp->children[2];
+    }
+    if (counter >= functionInfo[function_name].size()) return false;
+    if (temp->children[0]->type_annotation != functionInfo[function_name][counter]) return false;
+    ++counter;
+    if (counter != functionInfo[function_name].size()) return false;
     return true;
 }
 
-bool recursiveCheckCalls(TreeNode* node) {
-    if (node->token == "factor" && node->children.size() > 1 && node->children[0]->token == "ID") {
-        std::string function_name = node->children[0]->lexeme;
-        if (node->children.size() == 3) {
-            if (functionInfo[function_name].size() == 0) return true;
-            else return false;
+// Checks every call in a subtree, but not calls nested in arguments.
+bool checkCalls(TreeNode* node) {
+    return walkTree(node, [](TreeNode* it) {
+        if (it->token == "factor" && it->children.size() > 1 && it->children[0]->token == "ID") {
+            return checkCallArguments(it) ? WALK_SKIP_CHILDREN : WALK_STOP;
         }
-        else {
-            int counter = 0; TreeNode* temp = node->children[2];
-            while (temp->children.size() > 1) {
-                if (counter >= functionInfo[function_name].size()) return false;
-                if (temp->children[0]->type_annotation != functionInfo[function_name][counter]) return false;
-                ++counter;
-                temp = temp->children[2];
-            }
-            if (counter >= functionInfo[function_name].size()) return false;
-            if (temp->children[0]->type_annotation != functionInfo[function_name][counter]) return false;
-            ++counter;
-            if (counter != functionInfo[function_name].size()) return false;
-            return true;
-        }
-    }
-    for (auto it: node->children) {
-        if (!recursiveCheckCalls(it)) return false;
-    }
-    return true;
+        return WALK_CHILDREN;
+    });
 }
 
 bool checkCallsReturnValues(TreeNode* head) {
-    TreeNode* temp = head->children[1];
-    while (temp->children.size() > 1) {
-        TreeNode* procedure = temp->children[0];
+    TreeNode* procedures = head->children[1];
+    for (size_t i = 0; i + 1 < procedures->children.size(); ++i) {
+        TreeNode* procedure = procedures->children[i];
         if (procedure->children[9]->type_annotation != "int") return false;
-        if (!recursiveCheckCalls(procedure->children[9])) return false;
-        temp = temp->children[1];
+        if (!checkCalls(procedure->children[9])) return false;
     }
-    TreeNode* wain = temp->children[0];
+    TreeNode* wain = procedures->children.back();
     if (wain->children[11]->type_annotation != "int") return false;
-    if (!recursiveCheckCalls(wain->children[11])) return false;
+    if (!checkCalls(wain->children[11])) return false;
     return true;
 }
 
@@ -404,62 +275,248 @@ bool checkTestTypeErrors(TreeNode* test_node) {
 }
 
 bool checkStatementTypeErrors(TreeNode* head) {
-    if (head->token != "statement") {
-        for (auto it: head->children) {
-            if (!checkStatementTypeErrors(it)) return false;
+    return walkTree(head, [](TreeNode* node) {
+        if (node->token != "statement") return WALK_CHILDREN;
+        if (node->children.size() == 4) {
+            return node->children[0]->type_annotation == node->children[2]->type_annotation ? WALK_SKIP_CHILDREN : WALK_STOP;
+        }
+        if (node->children.size() == 5) {
+            if (node->children[0]->token == "DELETE") return node->children[3]->type_annotation == "int*" ? WALK_SKIP_CHILDREN : WALK_STOP;
+            else return node->children[2]->type_annotation == "int" ? WALK_SKIP_CHILDREN : WALK_STOP;
         }
-        return true;
+        // while and if: the test, then the statements inside
+        return checkTestTypeErrors(node->children[2]) ? WALK_CHILDREN : WALK_STOP;
+    });
+}
+
+// With --ast the input is the AST wlp4parse --ast prints (see wlp4ast.h),
+// and the same checks run on it: a program node holding the procedures and
+// then main, with parentheses, unit rules and punctuation already gone.
+// Expression nodes and declarations get their types, as in the parse tree.
+Ast ast;
+
+constexpr int AST_PROGRAM = astKindId("program");
+constexpr int AST_MAIN = astKindId("main");
+constexpr int AST_INT_STAR = astKindId("int*");
+constexpr int AST_DCL = astKindId("dcl");
+constexpr int AST_DCL_NUM = astKindId("dcl-num");
+constexpr int AST_DCL_NULL = astKindId("dcl-null");
+
+// Visits an AST subtree in preorder, as walkTree does a parse tree.
+template <typename Visit>
+bool walkAst(int root, Visit visit) {
+    std::vector<int> pending{root};
+    while (!pending.empty()) {
+        int node = pending.back();
+        pending.pop_back();
+        TreeWalk next = visit(node);
+        if (next == WALK_STOP) return false;
+        if (next != WALK_CHILDREN) continue;
+        size_t first = pending.size();
+        for (int child = ast.nodes[node].first_child; child >= 0; child = ast.nodes[child].next_sibling) pending.push_back(child);
+        std::reverse(pending.begin() + first, pending.end());
     }
-    if (head->children.size() == 4) {
-        if (head->children[0]->type_annotation != head->children[2]->type_annotation) return false;
+    return true;
+}
+
+std::string_view astKind(int node) {
+    return AST_KINDS[ast.nodes[node].kind];
+}
+
+std::string astLexeme(int node) {
+    return std::string(ast.nodes[node].lexeme);
+}
+
+std::string_view astType(int node) {
+    return ast.nodes[node].type;
+}
+
+bool isPointerDcl(int dcl) {
+    return ast.nodes[ast.child(dcl, 0)].kind == AST_INT_STAR;
+}
+
+bool buildAstTable(int node, std::unordered_map<std::string, std::string>& sym_table) {
+    return walkAst(node, [&](int it) {
+        int kind = ast.nodes[it].kind;
+        if (kind == AST_DCL_NUM || kind == AST_DCL_NULL) {
+            int dcl = ast.child(it, 0);
+            return declareVariable(astLexeme(dcl), !isPointerDcl(dcl), kind == AST_DCL_NUM ? 3 : 2, sym_table) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        }
+        if (kind == AST_DCL) return declareVariable(astLexeme(it), !isPointerDcl(it), 1, sym_table) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        if (astKind(it) == "call" && !symbol_table.contains(astLexeme(it))) return WALK_STOP;
+        return WALK_CHILDREN;
+    });
+}
+
+bool setupAstTables(int program) {
+    int procedure = ast.nodes[program].first_child;
+    for (; procedure >= 0 && ast.nodes[procedure].kind != AST_MAIN; procedure = ast.nodes[procedure].next_sibling) {
+        std::string name = astLexeme(procedure);
+        if (symbol_table.contains(name)) return false;
+        symbol_table[name] = std::unordered_map<std::string, std::string>();
+        functionInfo[name] = std::vector<std::string>();
+        for (int dcl = ast.nodes[ast.child(procedure, 0)].first_child; dcl >= 0; dcl = ast.nodes[dcl].next_sibling) {
+            functionInfo[name].emplace_back(isPointerDcl(dcl) ? "int*" : "int");
+        }
+        procedure_order.emplace_back(name);
+        if (!buildAstTable(procedure, symbol_table[name])) return false;
     }
-    if (head->children.size() == 5) {
-        if (head->children[0]->token == "DELETE") {
-            return (head->children[3]->type_annotation == "int*");
+    if (procedure < 0) return false;
+    symbol_table["wain"] = std::unordered_map<std::string, std::string>();
+    procedure_order.emplace_back("wain");
+    return buildAstTable(procedure, symbol_table["wain"]);
+}
+
+bool astDeclarationsCheck(int node, std::unordered_map<std::string, std::string>& sym_table) {
+    return walkAst(node, [&](int it) {
+        if (astKind(it) == "var") return sym_table.contains(astLexeme(it)) ? WALK_CHILDREN : WALK_STOP;
+        if (astKind(it) == "call") return symbol_table.contains(astLexeme(it)) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        return WALK_CHILDREN;
+    });
+}
+
+// The children of a procedure are params, dcls, statements and the
+// return value; main has its two parameters in place of params.
+bool astSemanticCheck(int procedure, const std::string& name) {
+    bool is_main = ast.nodes[procedure].kind == AST_MAIN;
+    int statements = ast.child(procedure, is_main ? 3 : 2);
+    if (!astDeclarationsCheck(statements, symbol_table[name])) return false;
+    if (is_main) {
+        int first_param = ast.child(procedure, 0);
+        int second_param = ast.child(procedure, 1);
+        if (ast.nodes[first_param].lexeme == ast.nodes[second_param].lexeme) return false;
+        if (isPointerDcl(second_param)) return false;
+    }
+    return astDeclarationsCheck(ast.child(procedure, is_main ? 4 : 3), symbol_table[name]);
+}
+
+// Types every node of a procedure after its children.
+void astTypeAnnotate(int procedure, std::unordered_map<std::string, std::string>& sym_table) {
+    std::vector<std::pair<int, bool>> pending{{procedure, false}};
+    while (!pending.empty()) {
+        auto [node, children_done] = pending.back();
+        pending.pop_back();
+        if (!children_done) {
+            pending.push_back({node, true});
+            for (int child = ast.nodes[node].first_child; child >= 0; child = ast.nodes[child].next_sibling) pending.push_back({child, false});
+            continue;
+        }
+        std::string_view kind = astKind(node);
+        std::string_view& type = ast.nodes[node].type;
+        if (kind == "dcl") type = isPointerDcl(node) ? "int*" : "int";
+        else if (kind == "dcl-num" || kind == "dcl-null") type = astType(ast.child(node, 0));
+        else if (kind == "num" || kind == "deref" || kind == "call" || kind == "getchar") type = "int";
+        else if (kind == "null" || kind == "address" || kind == "new") type = "int*";
+        else if (kind == "var") type = sym_table[astLexeme(node)];
+        else if (kind == "binary") {
+            std::string_view left = astType(ast.child(node, 0));
+            if (left != astType(ast.child(node, 1))) type = "int*";
+            else if (ast.nodes[node].lexeme == "-" && left == "int*") type = "int";
+            else type = left;
         }
-        else return (head->children[2]->type_annotation == "int");
     }
-    if (head->children.size() == 7) {
-        if (!checkTestTypeErrors(head->children[2]) || !checkStatementTypeErrors(head->children[5])) return false;
+}
+
+bool astCheckReferencing(int root) {
+    return walkAst(root, [](int node) {
+        if (astKind(node) == "deref" && astType(ast.child(node, 0)) == "int") return WALK_STOP;
+        if (astKind(node) == "address" && astType(ast.child(node, 0)) == "int*") return WALK_STOP;
+        return WALK_CHILDREN;
+    });
+}
+
+bool astCheckCallArguments(int call) {
+    const std::vector<std::string>& params = functionInfo[astLexeme(call)];
+    int args = ast.child(call, 0);
+    size_t count = 0;
+    for (int arg = args >= 0 ? ast.nodes[args].first_child : -1; arg >= 0; arg = ast.nodes[arg].next_sibling, ++count) {
+        if (count >= params.size() || astType(arg) != params[count]) return false;
     }
-    if (head->children.size() == 11) {
-        if (!checkTestTypeErrors(head->children[2]) || !checkStatementTypeErrors(head->children[5]) || !checkStatementTypeErrors(head->children[9])) return false;
+    return count == params.size();
+}
+
+// Like checkCallsReturnValues: the return values are ints and the calls in
+// them, though not calls nested in arguments, match their procedures.
+bool astCheckReturnValues(int program) {
+    for (int procedure = ast.nodes[program].first_child; procedure >= 0; procedure = ast.nodes[procedure].next_sibling) {
+        int value = ast.child(procedure, ast.nodes[procedure].kind == AST_MAIN ? 4 : 3);
+        if (astType(value) != "int") return false;
+        bool calls_ok = walkAst(value, [](int node) {
+            if (astKind(node) == "call") return astCheckCallArguments(node) ? WALK_SKIP_CHILDREN : WALK_STOP;
+            return WALK_CHILDREN;
+        });
+        if (!calls_ok) return false;
     }
     return true;
 }
 
+bool astCheckStatementTypeErrors(int root) {
+    return walkAst(root, [](int node) {
+        std::string_view kind = astKind(node);
+        if (kind == "assign") return astType(ast.child(node, 0)) == astType(ast.child(node, 1)) ? WALK_SKIP_CHILDREN : WALK_STOP;
+        if (kind == "delete") return astType(ast.child(node, 0)) == "int*" ? WALK_SKIP_CHILDREN : WALK_STOP;
+        if (kind == "println" || kind == "putchar") return astType(ast.child(node, 0)) == "int" ? WALK_SKIP_CHILDREN : WALK_STOP;
+        if (kind == "if" || kind == "while") {
+            int test = ast.child(node, 0);
+            return astType(ast.child(test, 0)) == astType(ast.child(test, 1)) ? WALK_CHILDREN : WALK_STOP;
+        }
+        return WALK_CHILDREN;
+    });
+}
 
-int main() {
-    terminals.insert("BOF"); terminals.insert("EOF"); terminals.insert("WAIN"); terminals.insert("LPAREN"); terminals.insert("INT"); terminals.insert("COMMA"); terminals.insert("RPAREN"); terminals.insert("LBRACE"); terminals.insert("RETURN"); terminals.insert("SEMI"); terminals.insert("RBRACE"); terminals.insert("STAR"); terminals.insert("ID"), terminals.insert("NUM"); terminals.insert("NULL"); terminals.insert(".EMPTY"); terminals.insert("PLUS"); terminals.insert("MINUS"); terminals.insert("SLASH"); terminals.insert("PCT"); terminals.insert("AMP"); terminals.insert("NEW"); terminals.insert("LBRACK"); terminals.insert("RBRACK"); terminals.insert("BECOMES"); terminals.insert("GETCHAR"); terminals.insert("WHILE"); terminals.insert("PRINTLN"); terminals.insert("PUTCHAR"); terminals.insert("DELETE"); terminals.insert("EQ"); terminals.insert("NE"); terminals.insert("LT"); terminals.insert("LE"); terminals.insert("GE"); terminals.insert("GT"); terminals.insert("IF"); terminals.insert("ELSE"); 
+int typeCheckAst() {
+    std::string text(std::istreambuf_iterator<char>(std::cin), {});
+    int program = ast.read(text);
+    if (program < 0 || ast.nodes[program].kind != AST_PROGRAM || !setupAstTables(program)) {formatError("ERROR"); return 1;}
 
-    TreeNode* head = new TreeNode{};
-    rebuildTree(head);
+    size_t i = 0;
+    for (int procedure = ast.nodes[program].first_child; procedure >= 0; procedure = ast.nodes[procedure].next_sibling, ++i) {
+        if (!astSemanticCheck(procedure, procedure_order[i])) {formatError("ERROR"); return 1;}
+    }
 
-    if (!setupTables(head->children[1])) {formatError("ERROR"); deleteNode(head); return 1;}
+    i = 0;
+    for (int procedure = ast.nodes[program].first_child; procedure >= 0; procedure = ast.nodes[procedure].next_sibling, ++i) {
+        astTypeAnnotate(procedure, symbol_table[procedure_order[i]]);
+    }
 
-    if (procedure_order.back() != "wain") {formatError("ERROR"); deleteNode(head); return 1;}
+    if (!astCheckReferencing(program)) {formatError("ERROR"); return 1;}
 
-    TreeNode* semantic_check_procedures = head->children[1];
+    if (!astCheckReturnValues(program)) {formatError("ERROR"); return 1;}
 
-    while (semantic_check_procedures->children.size() > 0) {
+    if (!astCheckStatementTypeErrors(program)) {formatError("ERROR"); return 1;}
 
-        if (!semanticCheck(semantic_check_procedures->children[0])) {formatError("ERROR"); deleteNode(head); return 1;}
+    ast.print(std::cout, program);
 
-        if (semantic_check_procedures->children.size() == 2) semantic_check_procedures = semantic_check_procedures->children[1];
-        else break;
+    return 0;
+}
+
+// Reads a parse tree in either list form (see wlp4tree.h) and writes the
+// typed tree in the same form. With --ast it reads and writes an AST.
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--ast") return typeCheckAst();
+
+    bool flat_lists = false;
+    TreeNode* head = readTree(std::cin, flat_lists);
+
+    if (!setupTables(head->children[1])) {formatError("ERROR"); deleteTree(head); return 1;}
+
+    if (procedure_order.back() != "wain") {formatError("ERROR"); deleteTree(head); return 1;}
+
+    for (auto procedure: head->children[1]->children) {
+        if (!semanticCheck(procedure)) {formatError("ERROR"); deleteTree(head); return 1;}
     }
 
     typeAnnotateAllProcedures(head->children[1]);
     
-    if (!checkReferencing(head)) {formatError("ERROR"); deleteNode(head); return 1;}
+    if (!checkReferencing(head)) {formatError("ERROR"); deleteTree(head); return 1;}
 
-    if (!checkCallsReturnValues(head)) {formatError("ERROR"); deleteNode(head); return 1;}
+    if (!checkCallsReturnValues(head)) {formatError("ERROR"); deleteTree(head); return 1;}
 
-    if (!checkStatementTypeErrors(head)) {formatError("ERROR"); deleteNode(head); return 1;}
+    if (!checkStatementTypeErrors(head)) {formatError("ERROR"); deleteTree(head); return 1;}
 
-    printParseTree(head);
+    printTree(std::cout, head, flat_lists);
 
-    deleteNode(head);
+    deleteTree(head);
 
     return 0;
-}
\ No newline at end of file
+}